@@ -45,14 +45,21 @@
 
 // #include <omp.h>
 #include "../tqdm/tqdm.h"
+#include "../common/EvaluationCache.hpp"
 
 typedef Feel::ParameterSpaceX::element_type element_t;
 typedef std::shared_ptr<Feel::CRBPluginAPI> plugin_ptr_t;
 typedef std::shared_ptr<Feel::ParameterSpaceX> parameter_space_ptr_t;
 
 
+/**
+ * @brief Load the plugin of the CRB database selected by the options
+ *
+ * @param dbRepository if not null, set to the repository of the loaded database
+ * @return std::shared_ptr<Feel::CRBPluginAPI>
+ */
 std::shared_ptr<Feel::CRBPluginAPI>
-loadPlugin()
+loadPlugin( std::string* dbRepository = nullptr )
 {
     using namespace Feel;
 
@@ -77,6 +84,12 @@ loadPlugin()
     }
     auto meta = crbmodelDB.loadDBMetaData( attribute, attribute_data );
     Feel::cout << "-- crbmodelDB::dbRepository()=" << crbmodelDB.dbRepository() << std::endl;
+    if ( dbRepository )
+    {
+        std::ostringstream repository;
+        repository << crbmodelDB.dbRepository();
+        *dbRepository = repository.str();
+    }
 
     return crbmodelDB.loadDBPlugin( meta, soption(_name="crbmodel.db.load" ) );
 }
@@ -190,16 +203,16 @@ void print_results_to_file(std::vector<double> param_vect, std::vector<double> o
  *
  * @param plugin std::vector containing the plugin from load_plugin
  * @param sampling_size size of the input sample used for computation of sobol indices
- * @param computeSecondOrder boolean to compute second order sobol indices
+ * @param dbRepository repository of the CRB database, used as key of the cache
  */
-int runSensitivityAnalysis( std::vector<plugin_ptr_t> plugin, size_t sampling_size )
+int runSensitivityAnalysis( std::vector<plugin_ptr_t> plugin, size_t sampling_size, std::string const& dbRepository )
 {
     using namespace Feel;
 
     bool loadFiniteElementDatabase = boption(_name="crb.load-elements-database");
 
     Eigen::VectorXd/*typename crb_type::vectorN_type*/ time_crb;
-    double online_tol = 1e-2;               //Feel::doption(Feel::_name="crb.online-tolerance");
+    double online_tol = doption(_name="crb.online-tolerance");
     int rbDim = ioption(_name="rb-dim");
     bool print_rb_matrix = false;           //boption(_name="crb.print-rb-matrix");
     parameter_space_ptr_t muspace = plugin[0]->parameterSpace();
@@ -243,13 +256,34 @@ int runSensitivityAnalysis( std::vector<plugin_ptr_t> plugin, size_t sampling_si
 
     std::vector<double> params_vect = linspace(min_value, max_value, sampling_size);
 
+    std::shared_ptr<EvaluationCache> cache;
+    if ( boption(_name="cache.enable") )
+    {
+        try
+        {
+            cache = std::make_shared<EvaluationCache>( Environment::expand( soption(_name="cache.directory") ),
+                EvaluationCache::modelKey( dbRepository, rbDim, online_tol ), dim );
+            Feel::cout << "Use cache " << cache->path() << " (" << cache->size() << " entries)" << std::endl;
+        }
+        catch ( std::exception const& e )
+        {
+            Feel::cout << tc::red << "Cache disabled: " << e.what() << tc::reset << std::endl;
+        }
+    }
+
     for (size_t i: tqdm::range(sampling_size))
     // for (size_t i = 0; i < sampling_size; ++i)
     {
         mu.setParameterNamed(param, params_vect[i]);
+        if ( cache && cache->find( mu.data(), &results[i] ) )
+            continue;
         Feel::CRBResults crbResult = plugin[0]->run( mu, time_crb, online_tol, rbDim, print_rb_matrix );
         results[i] = boost::get<0>( crbResult )[0];
+        if ( cache )
+            cache->insert( mu.data(), &results[i] );
     }
+    if ( cache )
+        cache->sync();
 
     print_results_to_file(params_vect, results, "deterministic_analysis_" + param + ".csv");
 
@@ -274,6 +308,8 @@ int main( int argc, char** argv )
         ( "sampling.size", po::value<int>()->default_value( 2000 ), "size of sampling" )
         ( "sampling.type", po::value<std::string>()->default_value( "random" ), "type of sampling" )
         ( "rb-dim", po::value<int>()->default_value( -1 ), "reduced basis dimension used (-1 use the max dim)" )
+        ( "cache.enable", po::value<bool>()->default_value( false ), "look up the outputs in a persistent cache before running the online code" )
+        ( "cache.directory", po::value<std::string>()->default_value( "${repository}/crbdb/cache" ), "directory of the persistent cache of the outputs" )
         ( "output_results.save.path", po::value<std::string>(), "output_results.save.path" )
 
 
@@ -302,9 +338,10 @@ int main( int argc, char** argv )
                      _desc_lib = crbonlinerunliboptions.add( feel_options() ),
                      _about = makeAbout() );
 
-    plugin_ptr_t plugin = loadPlugin();
+    std::string dbRepository;
+    plugin_ptr_t plugin = loadPlugin( &dbRepository );
     // runCrbOnline( { plugin } );
-    int err = runSensitivityAnalysis( { plugin }, ioption(_name="sampling.size") );
+    int err = runSensitivityAnalysis( { plugin }, ioption(_name="sampling.size"), dbRepository );
 
     if (err == 0)
         Feel::cout << tc::green << "Done ✓" << tc::reset << std::endl;
@@ -0,0 +1,495 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file ChaosDesignMatrix.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Polynomial chaos fitted on a design matrix evaluated once, for cheap bootstrap replicates
+//!
+
+#ifndef __CHAOS_DESIGN_MATRIX_HPP__
+#define __CHAOS_DESIGN_MATRIX_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <Eigen/Dense>
+#include <openturns/OT.hxx>
+#include "FunctionalChaos.hpp"
+
+
+/**
+ * @brief First and total order Sobol indices of a chaos, from its coefficients
+ *
+ * @param coefficients coefficients of the terms of the support
+ * @param multiIndices multi-indices of the terms of the basis
+ * @param support indices of the terms in the basis
+ * @return tuple of first and total order indices
+ */
+inline std::tuple<OT::Point, OT::Point> chaosSobolIndices( Eigen::VectorXd const& coefficients, std::vector<OT::Indices> const& multiIndices,
+                                                           std::vector<size_t> const& support )
+{
+    size_t dim = multiIndices.empty() ? 0 : multiIndices[0].getSize();
+    OT::Point first( dim ), total( dim );
+    double variance = 0;
+    for (size_t t = 0; t < support.size(); ++t)
+    {
+        OT::Indices const& alpha = multiIndices[support[t]];
+        double c2 = coefficients[t] * coefficients[t];
+        size_t active = 0, last = 0;
+        for (size_t i = 0; i < dim; ++i)
+            if ( alpha[i] > 0 )
+            {
+                ++active;
+                last = i;
+                total[i] += c2;
+            }
+        if ( active == 0 )
+            continue;
+        variance += c2;
+        if ( active == 1 )
+            first[last] += c2;
+    }
+    for (size_t i = 0; i < dim; ++i)
+    {
+        first[i] /= variance;
+        total[i] /= variance;
+    }
+    return std::make_tuple( first, total );
+}
+
+/**
+ * @brief Design matrix Psi(k, j) = psi_j(T(x_k)) of an orthonormal polynomial basis on a sample
+ *
+ * T is the transformation from the distribution of the inputs to the measure of
+ * the basis, as in OT::FunctionalChaosAlgorithm. The matrix is evaluated once,
+ * then each fit is a weighted least squares solve on a subset of its columns:
+ * a bootstrap replicate only changes the weights of the rows, which are the
+ * multiplicities of the samples in the selection.
+ */
+class ChaosDesignMatrix
+{
+public:
+    typedef std::vector<size_t> support_t;
+
+    /**
+     * @brief Construct a new ChaosDesignMatrix object
+     *
+     * @param X input sample
+     * @param distribution distribution of the inputs
+     * @param basis orthonormal polynomial basis
+     * @param total_degree maximal total degree of the polynomials
+     */
+    ChaosDesignMatrix( OT::Sample const& X, OT::Distribution const& distribution,
+                       OT::OrthogonalProductPolynomialFactory const& basis, OT::UnsignedInteger total_degree ) :
+        M_dim(X.getDimension()),
+        M_transformation(distribution, basis.getMeasure())
+    {
+        OT::EnumerateFunction enumerate = basis.getEnumerateFunction();
+        size_t P = enumerate.getBasisSizeFromTotalDegree( total_degree );
+        M_psi.resize( 0, P );
+        M_multiIndices.resize( P );
+        M_functions.resize( P );
+        for (size_t j = 0; j < P; ++j)
+        {
+            M_functions[j] = basis.build( j );
+            M_multiIndices[j] = enumerate( j );
+        }
+        append( X );
+    }
+
+    /**
+     * @brief Add the rows of new samples, the rows already computed being kept
+     *
+     * @param X new input samples
+     */
+    void append( OT::Sample const& X )
+    {
+        size_t n = size(), m = X.getSize();
+        if ( m == 0 )
+            return;
+        OT::Sample Z = M_transformation( X );
+        M_psi.conservativeResize( n + m, Eigen::NoChange );
+        for (size_t j = 0; j < M_functions.size(); ++j)
+        {
+            OT::Sample psi = M_functions[j]( Z );
+            for (size_t k = 0; k < m; ++k)
+                M_psi(n + k, j) = psi(k, 0);
+        }
+    }
+
+    // Accessors
+    size_t size() const { return M_psi.rows(); };
+    size_t basisSize() const { return M_psi.cols(); };
+    Eigen::MatrixXd const& matrix() const { return M_psi; };
+
+    /**
+     * @brief Whether there are more samples than terms in the support, so that its least squares chaos is determined
+     */
+    bool determined( size_t support_size ) const { return size() > support_size; }
+    bool determined() const { return determined( basisSize() ); }
+
+    /**
+     * @brief Support made of all the terms of the basis
+     */
+    support_t fullSupport() const
+    {
+        support_t support( basisSize() );
+        for (size_t j = 0; j < support.size(); ++j)
+            support[j] = j;
+        return support;
+    }
+
+    /**
+     * @brief Support selected by the sparse least squares chaos on the whole sample
+     */
+    support_t sparseSupport( OT::Sample const& X, OT::Sample const& Y, OT::OrthogonalProductPolynomialFactory const& basis,
+                             OT::UnsignedInteger total_degree, OT::Distribution const& distribution ) const
+    {
+        OT::Indices indices = computeSparseLeastSquaresChaos( X, Y, basis, total_degree, distribution ).getIndices();
+        return support_t( indices.begin(), indices.end() );
+    }
+
+    /**
+     * @brief Weighted least squares coefficients on a support
+     *
+     * The rows of non-zero weight, scaled by the square root of their weight, are
+     * solved by the column pivoting QR factorization, as in sobolIndices( Y ).
+     *
+     * @param psi columns of the design matrix of the support
+     * @param y outputs
+     * @param w non-negative weights of the rows
+     * @return Eigen::VectorXd coefficients of the terms of the support
+     * @throw std::invalid_argument if there are not more rows of non-zero weight than terms
+     */
+    static Eigen::VectorXd fit( Eigen::MatrixXd const& psi, Eigen::VectorXd const& y, Eigen::VectorXd const& w )
+    {
+        size_t rows = weightedRows( w );
+        if ( rows <= size_t( psi.cols() ) )
+            throw std::invalid_argument( "ChaosDesignMatrix::fit: " + std::to_string( rows ) + " sample(s) of non-zero weight for "
+                                         + std::to_string( psi.cols() ) + " term(s), the least squares chaos is not determined" );
+        Eigen::MatrixXd A( rows, psi.cols() );
+        Eigen::VectorXd b( rows );
+        for (Eigen::Index k = 0, r = 0; k < psi.rows(); ++k)
+        {
+            if ( w[k] <= 0 )
+                continue;
+            double s = std::sqrt( w[k] );
+            A.row(r) = s * psi.row(k);
+            b[r++] = s * y[k];
+        }
+        return A.colPivHouseholderQr().solve( b );
+    }
+
+    /**
+     * @brief Number of rows of non-zero weight
+     */
+    static size_t weightedRows( Eigen::VectorXd const& w ) { return ( w.array() > 0 ).count(); }
+
+    /**
+     * @brief Relative leave-one-out error of the least squares chaos on all the terms of the basis
+     */
+    double leaveOneOutError( OT::Sample const& Y ) const { return leaveOneOutError( Y, fullSupport() ); }
+
+    /**
+     * @brief Relative leave-one-out error of the least squares chaos on a support
+     *
+     * The leave-one-out residuals are e_k / (1 - h_k), e being the residuals of the
+     * fit on the whole sample and h the diagonal of the hat matrix Psi (Psi^T Psi)^-1 Psi^T,
+     * given by the thin QR factorization Psi = QR as h_k = |Q(k, :)|^2: no refit is needed.
+     *
+     * @param Y outputs of the sample
+     * @param support terms of the chaos
+     * @return double mean of the squared leave-one-out residuals over the variance of Y,
+     *         infinity if there are not more samples than terms
+     */
+    double leaveOneOutError( OT::Sample const& Y, support_t const& support ) const
+    {
+        Eigen::MatrixXd Q;
+        Eigen::VectorXd y, residuals;
+        if ( !leastSquares( Y, support, Q, y, residuals ) )
+            return std::numeric_limits<double>::infinity();
+        size_t n = size();
+        Eigen::VectorXd h = Q.rowwise().squaredNorm();
+
+        double loo = 0;
+        for (size_t k = 0; k < n; ++k)
+        {
+            if ( h[k] >= 1 - 1e-12 )
+                return std::numeric_limits<double>::infinity();
+            double e = residuals[k] / ( 1 - h[k] );
+            loo += e * e;
+        }
+        return loo / n / variance( y );
+    }
+
+    /**
+     * @brief Relative K-fold cross-validation error of the least squares chaos on a support
+     *
+     * The sample k is in the fold k mod K. The residuals of the fold F, fitted
+     * without it, are (I - H_FF)^-1 e_F, H_FF = Q_F Q_F^T being the block of the
+     * hat matrix of the fold: no refit is needed either.
+     *
+     * @param Y outputs of the sample
+     * @param support terms of the chaos
+     * @param folds number of folds K
+     * @return double mean of the squared cross-validation residuals over the variance of Y
+     */
+    double kFoldError( OT::Sample const& Y, support_t const& support, size_t folds ) const
+    {
+        Eigen::MatrixXd Q;
+        Eigen::VectorXd y, residuals;
+        if ( !leastSquares( Y, support, Q, y, residuals ) )
+            return std::numeric_limits<double>::infinity();
+        size_t n = size();
+        folds = std::clamp<size_t>( folds, 2, n );
+
+        double cv = 0;
+        for (size_t f = 0; f < folds; ++f)
+        {
+            std::vector<size_t> rows;
+            for (size_t k = f; k < n; k += folds)
+                rows.push_back( k );
+            Eigen::MatrixXd QF( rows.size(), Q.cols() );
+            Eigen::VectorXd eF( rows.size() );
+            for (size_t r = 0; r < rows.size(); ++r)
+            {
+                QF.row(r) = Q.row(rows[r]);
+                eF[r] = residuals[rows[r]];
+            }
+            Eigen::MatrixXd IH = Eigen::MatrixXd::Identity( rows.size(), rows.size() ) - QF * QF.transpose();
+            cv += IH.partialPivLu().solve( eF ).squaredNorm();
+        }
+        return cv / n / variance( y );
+    }
+
+    /**
+     * @brief First and total order Sobol indices of a chaos, from its coefficients
+     *
+     * @param coefficients coefficients of the terms of the support
+     * @param support indices of the terms in the basis
+     * @return tuple of first and total order indices
+     */
+    std::tuple<OT::Point, OT::Point> sobolIndices( Eigen::VectorXd const& coefficients, support_t const& support ) const
+    {
+        return chaosSobolIndices( coefficients, M_multiIndices, support );
+    }
+
+    /**
+     * @brief First and total order Sobol indices of the least squares chaos on all the terms of the basis
+     *
+     * @param Y outputs of the sample
+     * @return tuple of first and total order indices
+     * @throw std::runtime_error if there are not more samples than terms
+     */
+    std::tuple<OT::Point, OT::Point> sobolIndices( OT::Sample const& Y ) const
+    {
+        if ( !determined() )
+            throw std::runtime_error( "ChaosDesignMatrix::sobolIndices: " + std::to_string( size() ) + " sample(s) for "
+                                      + std::to_string( basisSize() ) + " term(s), the least squares chaos is not determined" );
+        Eigen::VectorXd y( size() );
+        for (size_t k = 0; k < size(); ++k)
+            y[k] = Y(k, 0);
+        Eigen::VectorXd coefficients = M_psi.colPivHouseholderQr().solve( y );
+        return sobolIndices( coefficients, fullSupport() );
+    }
+
+    /**
+     * @brief Bootstrap samples of the Sobol indices
+     *
+     * The selection of the replicate i is bootstrapSelection( n, seed, i ), so that
+     * the replicates are the ones of computeBootstrapChaosSobolIndices.
+     *
+     * @param Y outputs of the sample
+     * @param support terms of the chaos, fixed for all the replicates
+     * @param bootstrap_size number of replicates
+     * @param nthreads number of threads computing the replicates
+     * @param seed seed of the bootstrap selections
+     * @param eps replicates with indices outside of [eps, 1 - eps] are discarded
+     * @return tuple of samples of the first and total order indices, without the replicates
+     *         discarded and the ones drawing not more distinct samples than terms
+     * @throw std::runtime_error if there are not more samples than terms in the support
+     */
+    std::tuple<OT::Sample, OT::Sample> bootstrap( OT::Sample const& Y, support_t const& support, size_t bootstrap_size,
+                                                  size_t nthreads = 1, std::uint64_t seed = 0, double eps = 1e-9 ) const
+    {
+        size_t n = size();
+        if ( !determined( support.size() ) )
+            throw std::runtime_error( "ChaosDesignMatrix::bootstrap: " + std::to_string( n ) + " sample(s) for "
+                                      + std::to_string( support.size() ) + " term(s), the least squares chaos is not determined" );
+        Eigen::MatrixXd psi( n, support.size() );
+        for (size_t t = 0; t < support.size(); ++t)
+            psi.col(t) = M_psi.col(support[t]);
+        Eigen::VectorXd y( n );
+        for (size_t k = 0; k < n; ++k)
+            y[k] = Y(k, 0);
+
+        std::vector<OT::Point> fo_replicates(bootstrap_size), to_replicates(bootstrap_size);
+        parallelFor( bootstrap_size, nthreads, 1, [&]( size_t, size_t begin, size_t end ) {
+            Eigen::VectorXd w( n );
+            for (size_t i = begin; i < end; ++i)
+            {
+                w.setZero();
+                OT::Indices selection = bootstrapSelection( n, seed, i );
+                for (size_t k = 0; k < n; ++k)
+                    w[selection[k]] += 1;
+                // a replicate drawing too few distinct samples does not determine the chaos
+                if ( weightedRows( w ) > support.size() )
+                    std::tie( fo_replicates[i], to_replicates[i] ) = sobolIndices( fit( psi, y, w ), support );
+            }
+        } );
+
+        OT::Sample fo_sample(0, M_dim), to_sample(0, M_dim);
+        for (size_t i = 0; i < bootstrap_size; ++i)
+        {
+            bool valid = fo_replicates[i].getDimension() == M_dim;
+            for (size_t j = 0; valid && j < M_dim; ++j)
+                valid = valid && fo_replicates[i][j] >= eps && fo_replicates[i][j] <= 1 - eps
+                              && to_replicates[i][j] >= eps && to_replicates[i][j] <= 1 - eps;
+            if ( valid )
+            {
+                fo_sample.add( fo_replicates[i] );
+                to_sample.add( to_replicates[i] );
+            }
+        }
+        return std::make_tuple( fo_sample, to_sample );
+    }
+
+private:
+    /**
+     * @brief Least squares fit on a support, through the thin QR factorization of its columns
+     *
+     * @return false if there are not more samples than terms
+     */
+    bool leastSquares( OT::Sample const& Y, support_t const& support, Eigen::MatrixXd& Q, Eigen::VectorXd& y, Eigen::VectorXd& residuals ) const
+    {
+        size_t n = size(), P = support.size();
+        if ( !determined( P ) )
+            return false;
+        Eigen::MatrixXd psi( n, P );
+        for (size_t t = 0; t < P; ++t)
+            psi.col(t) = M_psi.col(support[t]);
+        y.resize( n );
+        for (size_t k = 0; k < n; ++k)
+            y[k] = Y(k, 0);
+
+        Eigen::HouseholderQR<Eigen::MatrixXd> qr( psi );
+        Q = qr.householderQ() * Eigen::MatrixXd::Identity( n, P );
+        residuals = y - Q * ( Q.transpose() * y );
+        return true;
+    }
+
+    static double variance( Eigen::VectorXd const& y )
+    {
+        return ( y.array() - y.mean() ).square().sum() / ( y.size() - 1 );
+    }
+
+    size_t M_dim;
+    OT::DistributionTransformation M_transformation;
+    std::vector<OT::Function> M_functions;
+    Eigen::MatrixXd M_psi;
+    std::vector<OT::Indices> M_multiIndices;
+};
+
+/**
+ * @brief Basis and total degree of a chaos selected by its leave-one-out error
+ */
+struct ChaosDegree
+{
+    OT::UnsignedInteger degree;
+    OT::OrthogonalProductPolynomialFactory basis;
+    double error;
+};
+
+/**
+ * @brief Orthonormal basis of the marginals of a distribution, truncated with a q-norm
+ *
+ * @param distribution distribution of the inputs
+ * @param q q-norm of the hyperbolic truncation, 1 for the usual total degree truncation
+ * @return OT::OrthogonalProductPolynomialFactory
+ */
+inline OT::OrthogonalProductPolynomialFactory chaosBasis( OT::Distribution const& distribution, double q = 1 )
+{
+    size_t dim = distribution.getDimension();
+    OT::Collection<OT::Distribution> marginals( dim );
+    for (size_t j = 0; j < dim; ++j)
+        marginals[j] = distribution.getMarginal(j);
+    if ( q >= 1 )
+        return OT::OrthogonalProductPolynomialFactory( marginals );
+    return OT::OrthogonalProductPolynomialFactory( marginals, OT::HyperbolicAnisotropicEnumerateFunction( dim, q ) );
+}
+
+/**
+ * @brief Select the total degree of the chaos minimizing the leave-one-out error
+ *
+ * The degrees 1 to max_degree are the candidates, the ones with more terms than
+ * samples being skipped. Each candidate is scored on its own design matrix, the
+ * candidates being evaluated in parallel, each one with its own distribution and
+ * basis, which share no implementation with the other candidates.
+ *
+ * @param X input sample
+ * @param Y output sample
+ * @param distribution distribution of the inputs
+ * @param max_degree maximal total degree tried
+ * @param q q-norm of the hyperbolic truncation of the bases
+ * @param nthreads number of threads evaluating the candidates
+ * @return ChaosDegree selected degree, basis and leave-one-out error
+ */
+inline ChaosDegree selectChaosDegree( OT::Sample const& X, OT::Sample const& Y, OT::Distribution const& distribution,
+                                      OT::UnsignedInteger max_degree, double q = 1, size_t nthreads = 1 )
+{
+    if ( max_degree < 1 )
+        throw std::invalid_argument( "selectChaosDegree: the maximal total degree must be at least 1, not " + std::to_string( max_degree ) );
+    std::vector<OT::Distribution> distributions;
+    std::vector<OT::OrthogonalProductPolynomialFactory> bases;
+    for (size_t d = 0; d < max_degree; ++d)
+    {
+        distributions.push_back( independentDistribution( distribution ) );
+        bases.push_back( chaosBasis( distributions[d], q ) );
+    }
+    std::vector<double> errors( max_degree, std::numeric_limits<double>::infinity() );
+
+    parallelFor( max_degree, nthreads, 1, [&]( size_t, size_t begin, size_t end ) {
+        for (size_t d = begin; d < end; ++d)
+        {
+            if ( bases[d].getEnumerateFunction().getBasisSizeFromTotalDegree( d + 1 ) >= X.getSize() )
+                continue;
+            errors[d] = ChaosDesignMatrix( X, distributions[d], bases[d], d + 1 ).leaveOneOutError( Y );
+        }
+    } );
+
+    size_t best = 0;
+    for (size_t d = 0; d < max_degree; ++d)
+    {
+        Feel::cout << "Chaos of total degree " << d + 1 << ": leave-one-out error " << errors[d] << std::endl;
+        if ( errors[d] < errors[best] )
+            best = d;
+    }
+    if ( std::isinf( errors[best] ) )
+        throw std::runtime_error( "selectChaosDegree: the sample is too small for a chaos of degree 1" );
+    return ChaosDegree{ OT::UnsignedInteger( best + 1 ), bases[best], errors[best] };
+}
+
+
+#endif // __CHAOS_DESIGN_MATRIX_HPP__
@@ -0,0 +1,309 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file Checkpoint.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Checkpoint of the state of a sensitivity analysis, to resume an interrupted run
+//!
+
+#ifndef __CHECKPOINT_HPP__
+#define __CHECKPOINT_HPP__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <openturns/OT.hxx>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/**
+ * @brief State of a run saved in a directory
+ *
+ * The state is a set of key/value pairs, written to the file "state" by
+ * commit, the file being replaced atomically.
+ * The samples are stored in raw binary files which are only appended to:
+ * the number of rows of each sample is part of the state, so that rows
+ * written after the last commit are discarded when the run is resumed.
+ * The sample files are flushed to the disk before the state is replaced, so
+ * that after a crash the state never refers to rows which were not written.
+ */
+class Checkpoint
+{
+public:
+    /**
+     * @brief Open the checkpoint directory
+     *
+     * @param directory directory of the checkpoint
+     * @param resume read the state of the previous run, if any, otherwise start from scratch
+     * @param interval number of samples evaluated between two checkpoints
+     */
+    Checkpoint( std::string const& directory, bool resume, size_t interval ) :
+        M_directory(directory), M_interval(std::max<size_t>( interval, 1 )), M_resumed(false)
+    {
+        std::filesystem::create_directories( M_directory );
+        if ( resume && std::filesystem::exists( statePath() ) )
+        {
+            std::ifstream in( statePath() );
+            std::string line;
+            while ( std::getline( in, line ) )
+            {
+                size_t sep = line.find( ' ' );
+                if ( sep != std::string::npos )
+                    M_state[line.substr( 0, sep )] = line.substr( sep + 1 );
+            }
+            M_resumed = true;
+        }
+    };
+
+    // Accessors
+    std::string const& directory() const { return M_directory; };
+    size_t interval() const { return M_interval; };
+    bool resumed() const { return M_resumed; };
+    bool has( std::string const& key ) const { return M_state.count( key ) > 0; };
+
+    /**
+     * @brief Get a value of the state
+     *
+     * @param key key of the value
+     * @return std::string the value, as written by set
+     */
+    std::string const& value( std::string const& key ) const
+    {
+        auto it = M_state.find( key );
+        if ( it == M_state.end() )
+            throw std::runtime_error( "Checkpoint: no value " + key + " in " + statePath() );
+        return it->second;
+    }
+
+    template <typename T>
+    T get( std::string const& key ) const
+    {
+        std::istringstream in( value( key ) );
+        T v;
+        in >> v;
+        return v;
+    }
+
+    template <typename T>
+    T get( std::string const& key, T const& def ) const { return has( key ) ? get<T>( key ) : def; }
+
+    /**
+     * @brief Set a value of the state, saved at the next commit
+     *
+     * @param key key of the value, without space
+     * @param v value, written with operator<< on a single line
+     */
+    template <typename T>
+    void set( std::string const& key, T const& v )
+    {
+        std::ostringstream out;
+        out.precision( 17 );
+        out << v;
+        M_state[key] = out.str();
+    }
+
+    /**
+     * @brief Check that the state was saved by the same analysis, throw otherwise
+     *
+     * @param key key of the value identifying the analysis
+     * @param v expected value
+     */
+    template <typename T>
+    void check( std::string const& key, T const& v ) const
+    {
+        std::ostringstream out;
+        out.precision( 17 );
+        out << v;
+        if ( M_resumed && value( key ) != out.str() )
+            throw std::runtime_error( "Checkpoint: " + M_directory + " was saved with " + key + "=" + value( key ) + ", not " + out.str() );
+    }
+
+    /**
+     * @brief Set a small sample as a value of the state, which can be modified between two commits
+     *
+     * @param key key of the value
+     * @param sample sample to save
+     */
+    void setSample( std::string const& key, OT::Sample const& sample )
+    {
+        std::ostringstream out;
+        out.precision( 17 );
+        out << sample.getSize() << " " << sample.getDimension();
+        for ( size_t i = 0; i < sample.getSize(); ++i )
+            for ( size_t j = 0; j < sample.getDimension(); ++j )
+                out << " " << sample(i, j);
+        M_state[key] = out.str();
+    }
+
+    /**
+     * @brief Get a sample set with setSample
+     *
+     * @param key key of the value
+     * @return OT::Sample
+     */
+    OT::Sample getSample( std::string const& key ) const
+    {
+        std::istringstream in( value( key ) );
+        size_t n, dim;
+        in >> n >> dim;
+        OT::Sample sample( n, dim );
+        for ( size_t i = 0; i < n; ++i )
+            for ( size_t j = 0; j < dim; ++j )
+                in >> sample(i, j);
+        return sample;
+    }
+
+    /**
+     * @brief Save the rows of a sample added since the last save
+     *
+     * @param name name of the sample
+     * @param sample sample, whose first rows are the ones previously saved
+     */
+    void saveSample( std::string const& name, OT::Sample const& sample )
+    {
+        size_t rows = get<size_t>( name + ".rows", 0 );
+        size_t dim = sample.getDimension();
+        if ( rows > sample.getSize() || ( rows > 0 && get<size_t>( name + ".dim" ) != dim ) )
+            throw std::logic_error( "Checkpoint: sample " + name + " is not an extension of the saved one" );
+        std::filesystem::path path = samplePath( name );
+        if ( std::filesystem::exists( path ) )
+            std::filesystem::resize_file( path, rows * dim * sizeof(double) );
+        std::ofstream out( path, std::ios::binary | std::ios::app );
+        out.write( reinterpret_cast<char const*>( sample.data() + rows * dim ), ( sample.getSize() - rows ) * dim * sizeof(double) );
+        if ( !out )
+            throw std::runtime_error( "Checkpoint: failed to write " + path.string() );
+        M_unsynced.insert( path.string() );
+        set( name + ".rows", sample.getSize() );
+        set( name + ".dim", dim );
+    }
+
+    /**
+     * @brief Load the rows of a sample saved before the last commit
+     *
+     * @param name name of the sample
+     * @return OT::Sample
+     */
+    OT::Sample loadSample( std::string const& name ) const
+    {
+        size_t rows = get<size_t>( name + ".rows" );
+        size_t dim = get<size_t>( name + ".dim" );
+        OT::Sample sample( rows, dim );
+        if ( rows == 0 )
+            return sample;
+        std::ifstream in( samplePath( name ), std::ios::binary );
+        in.read( reinterpret_cast<char*>( &sample(0, 0) ), rows * dim * sizeof(double) );
+        if ( !in )
+            throw std::runtime_error( "Checkpoint: failed to read " + samplePath( name ) );
+        return sample;
+    }
+
+    /**
+     * @brief Save the state of the random generator of OpenTURNS
+     */
+    void saveRandomState() { saveRandomState( OT::RandomGenerator::GetState() ); }
+
+    /**
+     * @brief Save a state of the random generator of OpenTURNS, read by the thread drawing the samples
+     *
+     * @param state state of the random generator
+     */
+    void saveRandomState( OT::RandomGeneratorState const& state )
+    {
+        OT::Indices buffer = state.getBuffer();
+        std::ostringstream out;
+        for ( size_t i = 0; i < buffer.getSize(); ++i )
+            out << buffer[i] << " ";
+        set( "rng.buffer", out.str() );
+        set( "rng.index", state.getIndex() );
+    }
+
+    /**
+     * @brief Restore the state of the random generator of OpenTURNS
+     */
+    void restoreRandomState() const
+    {
+        std::istringstream in( value( "rng.buffer" ) );
+        OT::Indices buffer;
+        OT::UnsignedInteger v;
+        while ( in >> v )
+            buffer.add( v );
+        OT::RandomGenerator::SetState( OT::RandomGeneratorState( buffer, get<OT::UnsignedInteger>( "rng.index" ) ) );
+    }
+
+    /**
+     * @brief Write the state to the disk, replacing the previous one
+     *
+     * The samples saved since the last commit and the new state are flushed to
+     * the disk before the state is renamed, and the directory after it.
+     */
+    void commit()
+    {
+        for ( auto const& path : M_unsynced )
+            sync( path );
+        M_unsynced.clear();
+        std::string tmp = statePath() + ".tmp";
+        {
+            std::ofstream out( tmp );
+            for ( auto const& [key, v] : M_state )
+                out << key << " " << v << "\n";
+            if ( !out )
+                throw std::runtime_error( "Checkpoint: failed to write " + tmp );
+        }
+        sync( tmp );
+        std::filesystem::rename( tmp, statePath() );
+        sync( M_directory );
+    }
+
+private:
+    /**
+     * @brief Flush a file or a directory to the disk
+     */
+    static void sync( std::string const& path )
+    {
+        int fd = ::open( path.c_str(), O_RDONLY );
+        if ( fd < 0 )
+            throw std::runtime_error( "Checkpoint: failed to open " + path + ": " + std::strerror( errno ) );
+        int err = ::fsync( fd ) == 0 ? 0 : errno;
+        ::close( fd );
+        if ( err != 0 )
+            throw std::runtime_error( "Checkpoint: failed to sync " + path + ": " + std::strerror( err ) );
+    }
+
+    std::string statePath() const { return ( std::filesystem::path( M_directory ) / "state" ).string(); }
+    std::string samplePath( std::string const& name ) const { return ( std::filesystem::path( M_directory ) / ( name + ".bin" ) ).string(); }
+
+    std::string M_directory;
+    size_t M_interval;
+    bool M_resumed;
+    std::map<std::string, std::string> M_state;
+    std::set<std::string> M_unsynced;       // sample files written since the last commit
+};
+
+
+#endif // __CHECKPOINT_HPP__
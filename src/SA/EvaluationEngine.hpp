@@ -0,0 +1,187 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file EvaluationEngine.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Evaluation of the online code on raw parameters, reusing its buffers from one call to the other
+//!
+
+#ifndef __EVALUATION_ENGINE_HPP__
+#define __EVALUATION_ENGINE_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+#include <feel/feelmor/crbplugin_interface.hpp>
+
+
+/**
+ * @brief Evaluation of the outputs with one plugin
+ *
+ * The engine owns the parameter element, the timers and the blocks of
+ * parameters passed to the online code, which are allocated once and
+ * reused by each evaluation (one block per size of the last, shorter block): the parameters are read from row-major
+ * contiguous storage and the outputs are written in place.
+ * An engine is not thread safe, one engine is used per worker thread.
+ */
+class EvaluationEngine
+{
+public:
+    typedef Feel::ParameterSpaceX::element_type element_t;
+    typedef std::shared_ptr<Feel::CRBPluginAPI> plugin_ptr_t;
+    typedef std::chrono::steady_clock clock_t;
+
+    /**
+     * @brief Construct a new EvaluationEngine object
+     *
+     * @param plugin loaded plugin, not shared with other engines
+     * @param online_tol online tolerance
+     * @param rbDim size of the reduced basis
+     */
+    EvaluationEngine( plugin_ptr_t const& plugin, double online_tol, int rbDim ) :
+        M_plugin(plugin), M_mu(plugin->parameterSpace()->element()), M_dim(plugin->parameterSpace()->dimension()),
+        M_onlineTol(online_tol), M_rbDim(rbDim), M_blockSize(1)
+    {};
+
+    // Accessors
+    plugin_ptr_t const& plugin() const { return M_plugin; };
+    size_t dimension() const { return M_dim; };
+    Eigen::VectorXd const& timeCrb() const { return M_timeCrb; };
+    int rbDim() const { return M_rbDim; };
+
+    // Mutators
+    void setRbDim( int rbDim ) { M_rbDim = rbDim; };
+    void setBlockSize( size_t block )
+    {
+        M_blockSize = std::max<size_t>( block, 1 );
+        M_block.assign( M_blockSize, M_mu );
+        M_tails.clear();
+    };
+
+    /**
+     * @brief Evaluate the output of a single parameter
+     *
+     * @param x parameter, of size dimension
+     * @return double output
+     */
+    double evaluate( double const* x )
+    {
+        for (size_t j = 0; j < M_dim; ++j)
+            M_mu.setParameter(j, x[j]);
+        M_result = M_plugin->run( M_mu, M_timeCrb, M_onlineTol, M_rbDim, false );
+        return boost::get<0>( M_result )[0];
+    }
+
+    /**
+     * @brief Evaluate the output of a single parameter with a given size of the reduced basis, and its error bound
+     *
+     * @param x parameter, of size dimension
+     * @param rbDim size of the reduced basis
+     * @param bound a posteriori error bound of the output, infinite if the online code provides none
+     * @return double output
+     */
+    double evaluate( double const* x, int rbDim, double* bound )
+    {
+        for (size_t j = 0; j < M_dim; ++j)
+            M_mu.setParameter(j, x[j]);
+        M_result = M_plugin->run( M_mu, M_timeCrb, M_onlineTol, rbDim, false );
+        auto const& bounds = boost::get<0>( boost::get<6>( M_result ) );
+        *bound = bounds.empty() ? std::numeric_limits<double>::infinity() : bounds[0];
+        return boost::get<0>( M_result )[0];
+    }
+
+    /**
+     * @brief Evaluate n contiguous parameters
+     *
+     * With a block size greater than 1, the parameters are dispatched by blocks
+     * to the multi-parameter run() of the plugin, one call per block: this only
+     * saves the overhead of the plugin interface, the online code still assembling
+     * and solving the reduced problem of each parameter of the block in turn.
+     *
+     * @param X row-major parameters, of size n * dimension
+     * @param n number of parameters to evaluate
+     * @param Y outputs, of size n
+     * @param T wall-clock time of the online code for each parameter, of size n, or nullptr
+     */
+    void evaluate( double const* X, size_t n, double* Y, double* T )
+    {
+        if ( M_blockSize == 1 )
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto start = clock_t::now();
+                Y[i] = evaluate( X + i*M_dim );
+                if ( T )
+                    T[i] = std::chrono::duration<double>( clock_t::now() - start ).count();
+            }
+            return;
+        }
+
+        for (size_t begin = 0; begin < n; begin += M_blockSize)
+        {
+            size_t count = std::min( M_blockSize, n - begin );
+            std::vector<element_t>& block = this->block( count );
+            for (size_t i = 0; i < count; ++i)
+                for (size_t j = 0; j < M_dim; ++j)
+                    block[i].setParameter(j, X[(begin + i)*M_dim + j]);
+            auto start = clock_t::now();
+            M_results = M_plugin->run( block, M_onlineTol, M_rbDim, false );
+            double elapsed = std::chrono::duration<double>( clock_t::now() - start ).count();
+            for (size_t i = 0; i < count; ++i)
+            {
+                Y[begin + i] = boost::get<0>( M_results[i] )[0];
+                if ( T )
+                    T[begin + i] = elapsed / count;
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Block of count parameters passed to the online code, allocated on its first use only
+     */
+    std::vector<element_t>& block( size_t count )
+    {
+        if ( count == M_block.size() )
+            return M_block;
+        auto it = M_tails.find( count );
+        if ( it == M_tails.end() )
+            it = M_tails.emplace( count, std::vector<element_t>( count, M_mu ) ).first;
+        return it->second;
+    }
+
+    plugin_ptr_t M_plugin;
+    element_t M_mu;
+    std::vector<element_t> M_block;
+    std::map<size_t, std::vector<element_t>> M_tails;   // blocks shorter than the block size
+    Eigen::VectorXd M_timeCrb;
+    Feel::CRBResults M_result;
+    std::vector<Feel::CRBResults> M_results;
+    size_t M_dim;
+    double M_onlineTol;
+    int M_rbDim;
+    size_t M_blockSize;
+};
+
+
+#endif // __EVALUATION_ENGINE_HPP__
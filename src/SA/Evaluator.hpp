@@ -0,0 +1,488 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file Evaluator.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Evaluation of the reduced model outputs on samples of parameters
+//!
+
+#ifndef __EVALUATOR_HPP__
+#define __EVALUATOR_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <openturns/OT.hxx>
+#include <feel/feelmor/crbplugin_interface.hpp>
+
+#include "../tqdm/tqdm.h"
+#include "../common/ParallelFor.hpp"
+#include "../common/WorkStealingPool.hpp"
+#include "../common/EvaluationCache.hpp"
+#include "EvaluationEngine.hpp"
+#include "MPIScheduler.hpp"
+#include "SampleStore.hpp"
+
+
+class Evaluator
+{
+public:
+    typedef Feel::ParameterSpaceX::element_type element_t;
+    typedef std::shared_ptr<Feel::CRBPluginAPI> plugin_ptr_t;
+    typedef std::shared_ptr<Feel::ParameterSpaceX> parameter_space_ptr_t;
+
+    /**
+     * @brief Construct a new Evaluator object
+     *
+     * One worker thread is used per plugin, through its own evaluation engine:
+     * the plugins must be distinct instances, so that each thread owns its own
+     * CRB online workspace.
+     *
+     * @param plugins loaded plugins, one per worker thread
+     * @param online_tol online tolerance
+     * @param rbDim size of the reduced basis
+     */
+    Evaluator( std::vector<plugin_ptr_t> const& plugins, double online_tol, int rbDim ) :
+        M_onlineTol(online_tol), M_rbDim(rbDim), M_chunkSize(16), M_blockSize(1), M_errorThreshold(0), M_hybridRbDim(rbDim), M_escalated(0), M_uncertified(0)
+    {
+        if ( plugins.empty() )
+            throw std::invalid_argument( "Evaluator needs at least one plugin" );
+        for ( auto const& plugin : plugins )
+            M_engines.emplace_back( plugin, online_tol, rbDim );
+    };
+    ~Evaluator() {};
+
+    // Accessors
+    size_t nThreads() const { return M_engines.size(); };
+    parameter_space_ptr_t parameterSpace() const { return M_engines[0].plugin()->parameterSpace(); };
+    double onlineTolerance() const { return M_onlineTol; };
+    int rbDim() const { return M_rbDim; };
+    size_t blockSize() const { return M_blockSize; };
+    double errorThreshold() const { return M_errorThreshold; };
+    Eigen::VectorXd const& timeCrb() const { return M_engines[0].timeCrb(); };
+
+    // Mutators
+    void setChunkSize( size_t chunk ) { M_chunkSize = std::max<size_t>( chunk, 1 ); };
+    void setScheduler( std::shared_ptr<MPIScheduler> const& scheduler ) { M_scheduler = scheduler; };
+    void setBlockSize( size_t block )
+    {
+        M_blockSize = std::max<size_t>( block, 1 );
+        for ( auto& engine : M_engines )
+            engine.setBlockSize( M_blockSize );
+    };
+    void setCache( std::shared_ptr<EvaluationCache> const& cache ) { M_caches[M_rbDim] = cache; };
+    void setCache( std::shared_ptr<EvaluationCache> const& cache, int rbDim ) { M_caches[rbDim] = cache; };
+    void setStore( std::shared_ptr<SampleStore> const& store ) { M_store = store; };
+
+    /**
+     * @brief Certify the outputs of the reduced basis of the current size by their error bound
+     *
+     * The parameters whose a posteriori error bound is greater than the threshold
+     * are evaluated again with the next size of the ladder, until the bound is
+     * below the threshold or the ladder is exhausted. The evaluations then run one
+     * parameter at a time on a work-stealing pool, whatever the block size.
+     * Only the evaluations with the current size of the reduced basis are certified.
+     * With an MPI scheduler, the workers certify the outputs they evaluate, each
+     * one having to be given the same threshold and ladder as the master.
+     *
+     * @param threshold maximal error bound of the outputs, 0 to disable
+     * @param rbDims increasing sizes of the reduced basis tried in turn, larger than the
+     *        current one, -1 standing for the largest basis; empty to only count the outputs above the threshold
+     * @throw std::invalid_argument if the sizes of the ladder are not increasing from the current one
+     */
+    void setErrorThreshold( double threshold, std::vector<int> const& rbDims )
+    {
+        auto order = []( int rbDim ) { return rbDim < 0 ? std::numeric_limits<int>::max() : rbDim; };
+        for (size_t k = 0; k < rbDims.size() && threshold > 0; ++k)
+        {
+            int previous = k == 0 ? M_rbDim : rbDims[k - 1];
+            if ( order( rbDims[k] ) <= order( previous ) )
+                throw std::invalid_argument( "Evaluator::setErrorThreshold: the size " + std::to_string( rbDims[k] )
+                                             + " of the reduced basis is not larger than " + std::to_string( previous ) );
+        }
+        M_errorThreshold = threshold;
+        M_rbDims = rbDims;
+        M_hybridRbDim = M_rbDim;
+    };
+
+    /**
+     * @brief Generate the output sample from a given input sample
+     *
+     * With more than one plugin, the sample is split into chunks handed out
+     * dynamically to the worker threads, each writing its outputs in place in
+     * a preallocated buffer.
+     * With an MPI scheduler, the chunks are sent to the worker ranks instead,
+     * which evaluate them on their own threads.
+     * With a cache, only the parameters not found in the cache are evaluated,
+     * and their outputs are then added to the cache.
+     * With a store, the sample is appended to the store as a new segment, each
+     * row being written as soon as it is evaluated.
+     *
+     * @param input Sample of input parameters
+     * @return OT::Sample
+     */
+    OT::Sample output( OT::Sample const& input )
+    {
+        size_t n = input.getSize();
+        size_t dim = input.getDimension();
+        double const* X = input.data();
+        auto it = M_caches.find( M_rbDim );
+        EvaluationCache* cache = it == M_caches.end() ? nullptr : it->second.get();
+
+        std::vector<size_t> rows;
+        if ( M_store )
+        {
+            rows.resize( n );
+            std::iota( rows.begin(), rows.end(), M_store->reserve( n ) );
+        }
+
+        if ( !cache )
+        {
+            OT::Sample output = computeOutput( input, rows );
+            if ( M_store )
+                M_store->commit();
+            return output;
+        }
+
+        OT::Sample output(n, 1);
+        std::vector<size_t> missing;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double y;
+            if ( cache->find( X + i*dim, &y ) )
+            {
+                output(i, 0) = y;
+                if ( M_store )
+                    M_store->write( rows[i], X + i*dim, &y, nullptr, 1 );
+            }
+            else
+                missing.push_back( i );
+        }
+        Feel::cout << "Cache: " << n - missing.size() << " output(s) found over " << n << std::endl;
+
+        if ( !missing.empty() )
+        {
+            OT::Sample toCompute( missing.size(), dim );
+            std::vector<size_t> toComputeRows( M_store ? missing.size() : 0 );
+            for (size_t k = 0; k < missing.size(); ++k)
+            {
+                for (size_t j = 0; j < dim; ++j)
+                    toCompute(k, j) = X[missing[k]*dim + j];
+                if ( M_store )
+                    toComputeRows[k] = rows[missing[k]];
+            }
+            OT::Sample computed = computeOutput( toCompute, toComputeRows );
+            for (size_t k = 0; k < missing.size(); ++k)
+            {
+                double y = computed(k, 0);
+                output(missing[k], 0) = y;
+                cache->insert( X + missing[k]*dim, &y );
+            }
+            cache->sync();
+        }
+        if ( M_store )
+            M_store->commit();
+        return output;
+    }
+
+    /**
+     * @brief Generate the output sample from a given input sample, with another size of the reduced basis
+     *
+     * The cache of this size is used if it has been set, the store is not used.
+     *
+     * @param input Sample of input parameters
+     * @param rbDim size of the reduced basis
+     * @return OT::Sample
+     */
+    OT::Sample output( OT::Sample const& input, int rbDim )
+    {
+        if ( rbDim == M_rbDim )
+            return output( input );
+
+        int rbDimDefault = M_rbDim;
+        std::shared_ptr<SampleStore> store;
+        store.swap( M_store );
+        setRbDim( rbDim );
+        try
+        {
+            OT::Sample out = output( input );
+            setRbDim( rbDimDefault );
+            M_store.swap( store );
+            return out;
+        }
+        catch ( ... )
+        {
+            setRbDim( rbDimDefault );
+            M_store.swap( store );
+            throw;
+        }
+    }
+
+    /**
+     * @brief Generate the output sample by segments, each one being handed to a callback
+     *
+     * The callback chunk( begin, end, Y ) receives the outputs Y of the rows [begin, end)
+     * of the input. When it returns false, the evaluation stops after this segment:
+     * the returned sample then only holds the outputs of the first rows of the input,
+     * up to the end of the segment.
+     * With overlap, the callback runs on another thread during the evaluation of the
+     * next segment, which is dropped if the callback stops the evaluation; without
+     * it, the next segment is only evaluated once the callback has returned true.
+     * Each segment goes through output( input ), hence through the cache and the store.
+     *
+     * @param input Sample of input parameters
+     * @param segment number of rows of each segment
+     * @param chunk callback on each evaluated segment, returning false to stop the evaluation
+     * @param overlap whether the callback runs during the evaluation of the next segment
+     * @return OT::Sample outputs of the rows evaluated
+     */
+    template <typename Chunk>
+    OT::Sample output( OT::Sample const& input, size_t segment, Chunk&& chunk, bool overlap = true )
+    {
+        size_t n = input.getSize();
+        segment = std::max<size_t>( segment, 1 );
+        OT::Sample result( 0, 1 );
+        std::future<bool> pending;
+        for (size_t begin = 0; begin < n; begin += segment)
+        {
+            size_t end = std::min( begin + segment, n );
+            OT::Sample part = output( OT::Sample( input, begin, end ) );
+            if ( pending.valid() && !pending.get() )
+                break;
+            result.add( part );
+            if ( overlap )
+                pending = std::async( std::launch::async, [&chunk, begin, end, part]() { return bool( chunk( begin, end, part ) ); } );
+            else if ( !chunk( begin, end, part ) )
+                break;
+        }
+        if ( pending.valid() )
+            pending.get();
+        return result;
+    }
+
+    /**
+     * @brief Mean wall-clock time of the online code on the first rows of a sample
+     *
+     * The rows are evaluated by the first plugin on the calling thread, without
+     * the cache, the store or the MPI scheduler, so that the time is the one of
+     * the online code only.
+     *
+     * @param input Sample of input parameters
+     * @param rbDim size of the reduced basis
+     * @param count number of rows evaluated
+     * @return double time per evaluation in seconds, 0 for an empty sample
+     */
+    double onlineCost( OT::Sample const& input, int rbDim, size_t count )
+    {
+        count = std::min( count, input.getSize() );
+        if ( count == 0 )
+            return 0;
+        size_t dim = input.getDimension();
+        double bound;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+            M_engines[0].evaluate( input.data() + i*dim, rbDim, &bound );
+        return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() / count;
+    }
+
+    /**
+     * @brief Evaluate the chunks sent by the master rank until it stops the scheduler
+     *
+     * To be called on the worker ranks instead of running the analysis.
+     */
+    void serve()
+    {
+        if ( !M_scheduler || M_scheduler->isMaster() )
+            throw std::logic_error( "Evaluator::serve must be called on a worker rank of an MPI scheduler" );
+        // the size of the reduced basis is sent by the master along with each chunk
+        // compute certifies the outputs of the size of the reduced basis given to setErrorThreshold
+        M_scheduler->serve( parameterSpace()->dimension(), [this]( double const* X, size_t n, double* Y, std::int64_t rbDim ) {
+            setRbDim( rbDim );
+            compute( X, n, Y, nullptr, []( size_t, size_t ) {} );
+        } );
+        if ( M_errorThreshold > 0 )
+            std::cout << "Rank " << M_scheduler->rank() << ": " << M_escalated << " output(s) escalated, " << M_uncertified
+                      << " above " << M_errorThreshold << " with the largest reduced basis" << std::endl;
+    }
+
+private:
+    void setRbDim( int rbDim )
+    {
+        M_rbDim = rbDim;
+        for ( auto& engine : M_engines )
+            engine.setRbDim( rbDim );
+    }
+
+    /**
+     * @brief Generate the output sample from a given input sample, without the cache
+     *
+     * @param input Sample of input parameters
+     * @param rows rows of the store where the samples are written, empty without store
+     * @return OT::Sample
+     */
+    OT::Sample computeOutput( OT::Sample const& input, std::vector<size_t> const& rows )
+    {
+        size_t n = input.getSize();
+        size_t dim = input.getDimension();
+        double const* X = input.data();
+
+        if ( M_scheduler )
+        {
+            Feel::cout << "Start to compute outputs, sampling of size " << n << " on " << M_scheduler->nWorkers() << " MPI worker(s)" << std::endl;
+            OT::Sample output = M_scheduler->evaluate( input, M_rbDim );
+            Feel::cout << "output computed" << std::endl;
+            for (size_t i = 0; i < rows.size(); ++i)
+                M_store->write( rows[i], X + i*dim, &output(i, 0), nullptr, 1 );
+            return output;
+        }
+
+        // the outputs are written in place in the storage of the sample, the times only with a store
+        OT::Sample output(n, 1);
+        if ( n == 0 )
+            return output;
+        double* Y = &output(0, 0);
+        std::vector<double> times( rows.empty() ? 0 : n );
+        double* T = rows.empty() ? nullptr : times.data();
+        auto record = [&]( size_t begin, size_t end ) {
+            for (size_t i = begin; i < end && T; ++i)
+                M_store->write( rows[i], X + i*dim, Y + i, T + i, 1 );
+        };
+
+        Feel::cout << "Start to compute outputs, sampling of size " << n << " on " << nThreads() << " thread(s)" << std::endl;
+        if ( nThreads() == 1 && M_blockSize == 1 && !certified() )
+        {
+            for (size_t i: tqdm::range(n))
+            {
+                M_engines[0].evaluate( X + i*dim, 1, Y + i, T ? T + i : nullptr );
+                record( i, i + 1 );
+            }
+        }
+        else
+        {
+            compute( X, n, Y, T, [&]( size_t begin, size_t end ) { record( begin, end ); } );
+        }
+        Feel::cout << "output computed" << std::endl;
+        return output;
+    }
+
+    /**
+     * @brief Evaluate n contiguous parameters, spread over the worker threads
+     *
+     * @param X row-major parameters, of size n * dimension of the parameter space
+     * @param n number of parameters to evaluate
+     * @param Y outputs, of size n
+     * @param T online times, of size n, or nullptr
+     * @param done function called by the workers on each chunk [begin, end) once evaluated
+     */
+    template <typename Done>
+    void compute( double const* X, size_t n, double* Y, double* T, Done&& done )
+    {
+        if ( certified() )
+        {
+            certify( X, n, Y, T, done );
+            return;
+        }
+        size_t dim = parameterSpace()->dimension();
+        size_t chunk = std::max( M_chunkSize, M_blockSize );
+        parallelFor( n, nThreads(), chunk, [&]( size_t worker, size_t begin, size_t end ) {
+            M_engines[worker].evaluate( X + begin*dim, end - begin, Y + begin, T ? T + begin : nullptr );
+            done( begin, end );
+        } );
+    }
+
+    bool certified() const { return M_errorThreshold > 0 && M_rbDim == M_hybridRbDim; }
+
+    /**
+     * @brief Evaluate n contiguous parameters, escalating the ones whose error bound is above the threshold
+     *
+     * Each parameter is a task of a work-stealing pool, the workers starting
+     * with contiguous ranges of parameters. A parameter whose bound is too large
+     * is pushed back with the next size of the ladder on the deque of its worker,
+     * where it can be stolen by an idle worker, so that the costly evaluations
+     * are spread over the workers.
+     *
+     * @param X row-major parameters, of size n * dimension of the parameter space
+     * @param n number of parameters to evaluate
+     * @param Y outputs, of size n
+     * @param T online times, of size n and initialized to 0, or nullptr
+     * @param done function called by the workers on each parameter [i, i+1) once certified
+     */
+    template <typename Done>
+    void certify( double const* X, size_t n, double* Y, double* T, Done&& done )
+    {
+        struct Task
+        {
+            size_t index;
+            size_t level;       // 0 for the current size, else the index in the ladder plus one
+        };
+        size_t dim = parameterSpace()->dimension();
+        WorkStealingPool<Task> pool( std::min( nThreads(), std::max<size_t>( n, 1 ) ) );
+        for (size_t i = 0; i < n; ++i)
+            pool.push( i * pool.nThreads() / n, Task{ i, 0 } );
+
+        std::atomic<size_t> escalated{0}, uncertified{0};
+        pool.run( [&]( size_t worker, Task& task ) {
+            int rbDim = task.level == 0 ? M_rbDim : M_rbDims[task.level - 1];
+            double bound;
+            auto start = std::chrono::steady_clock::now();
+            double y = M_engines[worker].evaluate( X + task.index*dim, rbDim, &bound );
+            if ( T )
+                T[task.index] += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+            if ( bound > M_errorThreshold && task.level < M_rbDims.size() )
+            {
+                if ( task.level == 0 )
+                    ++escalated;
+                pool.push( worker, Task{ task.index, task.level + 1 } );
+                return;
+            }
+            if ( bound > M_errorThreshold )
+                ++uncertified;
+            Y[task.index] = y;
+            done( task.index, task.index + 1 );
+        } );
+        M_escalated += escalated;
+        M_uncertified += uncertified;
+        Feel::cout << "Error bound: " << escalated << " output(s) escalated over " << n << ", " << uncertified
+                   << " above " << M_errorThreshold << " with the largest reduced basis" << std::endl;
+    }
+
+    std::vector<EvaluationEngine> M_engines;
+    std::shared_ptr<MPIScheduler> M_scheduler;
+    std::map<int, std::shared_ptr<EvaluationCache>> M_caches;
+    std::shared_ptr<SampleStore> M_store;
+    double M_onlineTol;
+    int M_rbDim;
+    size_t M_chunkSize, M_blockSize;
+    double M_errorThreshold;
+    std::vector<int> M_rbDims;      // ladder of the sizes of the reduced basis of the escalation
+    int M_hybridRbDim;              // size of the reduced basis whose outputs are certified
+    size_t M_escalated, M_uncertified;  // totals of the certified evaluations
+};
+
+
+#endif // __EVALUATOR_HPP__
@@ -23,8 +23,66 @@
 //! @brief Functional chaos sensitivity analysis adapted from https://openturns.github.io/openturns/latest/auto_meta_modeling/polynomial_chaos_metamodel/plot_chaos_sobol_confidence.html
 //!
 
+#ifndef __FUNCTIONAL_CHAOS_HPP__
+#define __FUNCTIONAL_CHAOS_HPP__
 
+#include <cstdint>
+#include <random>
 #include <openturns/OT.hxx>
+#include "../common/ParallelFor.hpp"
+#include "MarginalSpec.hpp"
+
+/**
+ * @brief Distribution, basis and strategies of a chaos, built once and shared by all the fits
+ *
+ * Building the chaos without its distribution makes OpenTURNS infer the marginals
+ * and rebuild the basis at each fit, which costs more than the fit itself.
+ */
+class ChaosContext
+{
+public:
+    /**
+     * @brief Construct a new ChaosContext object
+     *
+     * @param distribution Distribution of the inputs
+     * @param basis multivariate orthogonal polynomial basis
+     * @param total_degree Maximum total degree of the polynomials
+     */
+    ChaosContext( OT::Distribution const& distribution, OT::OrthogonalProductPolynomialFactory const& basis,
+                  OT::UnsignedInteger total_degree ) :
+        M_distribution(distribution),
+        M_basis(basis),
+        M_totalDegree(total_degree),
+        M_adaptiveStrategy(basis, basis.getEnumerateFunction().getBasisSizeFromTotalDegree( total_degree )),
+        M_projectionStrategy(OT::LeastSquaresMetaModelSelectionFactory())
+    {}
+
+    // Accessors
+    OT::Distribution const& distribution() const { return M_distribution; };
+    OT::OrthogonalProductPolynomialFactory const& basis() const { return M_basis; };
+    OT::UnsignedInteger totalDegree() const { return M_totalDegree; };
+
+    /**
+     * @brief Sparse least squares chaos of a sample
+     *
+     * @param X Input training design of experiments
+     * @param Y Output training design of experiments
+     * @return OT::FunctionalChaosResult Polynomial chaos result
+     */
+    OT::FunctionalChaosResult fit( OT::Sample const& X, OT::Sample const& Y ) const
+    {
+        OT::FunctionalChaosAlgorithm polynomialChaosAlgorithm(X, Y, M_distribution, M_adaptiveStrategy, M_projectionStrategy);
+        polynomialChaosAlgorithm.run();
+        return polynomialChaosAlgorithm.getResult();
+    }
+
+private:
+    OT::Distribution M_distribution;
+    OT::OrthogonalProductPolynomialFactory M_basis;
+    OT::UnsignedInteger M_totalDegree;
+    OT::FixedStrategy M_adaptiveStrategy;
+    OT::LeastSquaresStrategy M_projectionStrategy;
+};
 
 /**
  * @brief Create a sparse least squares chaos with least squares
@@ -39,17 +97,7 @@
 OT::FunctionalChaosResult computeSparseLeastSquaresChaos( OT::Sample X, OT::Sample Y,
     OT::OrthogonalProductPolynomialFactory basis, OT::UnsignedInteger total_degree, OT::Distribution distribution)
 {
-    OT::LeastSquaresMetaModelSelectionFactory selectionAlgorithm;
-    OT::LeastSquaresStrategy projectionStrategy(selectionAlgorithm);
-    OT::EnumerateFunction enum_fonc = basis.getEnumerateFunction();
-    OT::UnsignedInteger P = enum_fonc.getBasisSizeFromTotalDegree( total_degree );
-    OT::FixedStrategy adaptiveStrategy( basis, P );
-
-    OT::FunctionalChaosAlgorithm polynomialChaosAlgorithm(X, Y, distribution, adaptiveStrategy, projectionStrategy);
-    polynomialChaosAlgorithm.run();
-
-    OT::FunctionalChaosResult result = polynomialChaosAlgorithm.getResult();
-    return result;
+    return ChaosContext( distribution, basis, total_degree ).fit( X, Y );
 }
 
 /**
@@ -66,6 +114,24 @@ void checkMetaModel(OT::Sample X_test, OT::Sample Y_test, OT::Function metamodel
     Feel::cout << Feel::tc::green << "Check of the metamodel : Q2 = " << Q2 << Feel::tc::reset << std::endl;
 }
 
+/**
+ * @brief Ckeck the metamodel with its predictions on a validation sample
+ *
+ * @param Y_test Output validation design of experiments
+ * @param Y_pred Predictions of the metamodel on the validation inputs
+ */
+void checkMetaModel(OT::Sample Y_test, OT::Sample Y_pred)
+{
+    double mean = Y_test.computeMean()[0], residual = 0, variance = 0;
+    for (size_t i = 0; i < Y_test.getSize(); ++i)
+    {
+        residual += ( Y_test(i, 0) - Y_pred(i, 0) ) * ( Y_test(i, 0) - Y_pred(i, 0) );
+        variance += ( Y_test(i, 0) - mean ) * ( Y_test(i, 0) - mean );
+    }
+    OT::Scalar Q2 = 1 - residual / variance;
+    Feel::cout << Feel::tc::green << "Check of the metamodel : Q2 = " << Q2 << Feel::tc::reset << std::endl;
+}
+
 /**
  * @brief Bootstrap two samples
  *
@@ -80,6 +146,27 @@ auto multiBootstrap(OT::Sample X, OT::Sample Y)
     return std::make_tuple(X.select(selection), Y.select(selection));
 }
 
+/**
+ * @brief Bootstrap selection of a replicate, drawn from its own random stream
+ *
+ * The stream only depends on the seed and on the index of the replicate, so that
+ * the replicates can be computed in any order.
+ *
+ * @param n size of the sample
+ * @param seed seed of the bootstrap
+ * @param replicate index of the replicate
+ * @return OT::Indices n indices drawn with replacement in [0, n)
+ */
+OT::Indices bootstrapSelection( size_t n, std::uint64_t seed, size_t replicate )
+{
+    std::seed_seq seq{ std::uint32_t( seed ), std::uint32_t( seed >> 32 ), std::uint32_t( replicate ), std::uint32_t( std::uint64_t( replicate ) >> 32 ) };
+    std::mt19937_64 rng( seq );
+    OT::Indices selection( n );
+    for (size_t k = 0; k < n; ++k)
+        selection[k] = rng() % n;
+    return selection;
+}
+
 /**
  * @brief Compute the first and total order Sobol's indices from a polynomial chaos
  *
@@ -119,11 +206,13 @@ auto computeChaosSensitivity( const OT::Sample X, const OT::Sample Y,
  * @param distribution Distribution of X
  * @param bootstrap_size Size of the bootstrap sample
  * @param eps Tolerance for the bootstrap, default to 1e-9
+ * @param nthreads Number of threads computing the replicates
+ * @param seed Seed of the bootstrap selections, the result only depends on it and not on nthreads
  * @return auto 
  */
 auto computeBootstrapChaosSobolIndices( const OT::Sample X, const OT::Sample Y,
     OT::OrthogonalProductPolynomialFactory basis, OT::UnsignedInteger total_degree, OT::Distribution distribution,
-    size_t bootstrap_size, OT::Scalar eps = 1e-9)
+    size_t bootstrap_size, OT::Scalar eps = 1e-9, size_t nthreads = 1, std::uint64_t seed = 0)
 {
     size_t dim_input = X.getDimension();
     OT::Sample fo_sample (0, dim_input);
@@ -136,15 +225,40 @@ auto computeBootstrapChaosSobolIndices( const OT::Sample X, const OT::Sample Y,
     }
     OT::Interval unit_eps(low, high);
 
-    for (size_t i = 0; i < bootstrap_size; ++i)
+    // each worker, the first one included, fits on its own distribution and basis, built again
+    // from the parameters of the marginals so that no implementation is shared between the threads;
+    // the indices of each replicate are stored in its slot and merged in order afterwards
+    size_t n = X.getSize();
+    nthreads = std::max<size_t>( 1, std::min( nthreads, bootstrap_size ) );
+    std::vector<OT::Distribution> distributions;
+    std::vector<OT::OrthogonalProductPolynomialFactory> bases;
+    for (size_t w = 0; w < nthreads; ++w)
     {
-        auto [X_boot, Y_boot] = multiBootstrap(X, Y);
+        distributions.push_back( independentDistribution( distribution ) );
+        OT::EnumerateFunction enumerate( basis.getEnumerateFunction().getImplementation()->clone() );
+        OT::Collection<OT::Distribution> marginals( dim_input );
+        for (size_t j = 0; j < dim_input; ++j)
+            marginals[j] = distributions[w].getMarginal(j);
+        bases.push_back( OT::OrthogonalProductPolynomialFactory( marginals, enumerate ) );
+    }
+    std::vector<OT::Point> fo_replicates(bootstrap_size), to_replicates(bootstrap_size);
 
-        auto [fo, to] = computeChaosSensitivity(X_boot, Y_boot, basis, total_degree, distribution);
-        if (unit_eps.contains(fo) && unit_eps.contains(to))
+    parallelFor( bootstrap_size, nthreads, 1, [&]( size_t worker, size_t begin, size_t end ) {
+        for (size_t i = begin; i < end; ++i)
         {
-            fo_sample.add(fo);
-            to_sample.add(to);
+            OT::Indices selection = bootstrapSelection( n, seed, i );
+            auto [fo, to] = computeChaosSensitivity( X.select(selection), Y.select(selection), bases[worker], total_degree, distributions[worker] );
+            fo_replicates[i] = fo;
+            to_replicates[i] = to;
+        }
+    } );
+
+    for (size_t i = 0; i < bootstrap_size; ++i)
+    {
+        if (unit_eps.contains(fo_replicates[i]) && unit_eps.contains(to_replicates[i]))
+        {
+            fo_sample.add(fo_replicates[i]);
+            to_sample.add(to_replicates[i]);
         }
     }
     return std::make_tuple(fo_sample, to_sample);
@@ -179,26 +293,19 @@ auto computeSobolIndicesConfidenceInterval(OT::Sample fo_sample, OT::Sample to_s
 }
 
 /**
- * @brief Compute and draw Sobol' indices from a polynomial chaos based on a given sample size
+ * @brief Set the indices and intervals from bootstrap samples of the indices, and draw them
  *
  * @param res Result where indices are stored
- * @param X Input design
- * @param Y Output design
- * @param basis Tensorized polynomial basis
- * @param total_degree Maximum total degree of the polynomials
- * @param distribution Distribution of X
- * @param bootstrap_size Size of the bootstrap sample
+ * @param names Names of the inputs
+ * @param N Size of the sample the indices are computed from
+ * @param fo_sample Bootstrap sample of the first order indices
+ * @param to_sample Bootstrap sample of the total order indices
  * @param alpha Confidence level
  * @return OT::Graph Graph of the Sobol' indices
  */
-OT::Graph computeAndDrawSobolIndices( Results &res, OT::Sample X, OT::Sample Y, OT::OrthogonalProductPolynomialFactory basis,
-    OT::UnsignedInteger total_degree, OT::Distribution distribution, size_t bootstrap_size=500, OT::Scalar alpha = 0.95)
+OT::Graph setAndDrawSobolIndices( Results &res, OT::Description const& names, size_t N, OT::Sample const& fo_sample, OT::Sample const& to_sample,
+    OT::Scalar alpha = 0.95)
 {
-    size_t N = X.getSize();
-    Feel::cout << "Compute bootstrap chaos Sobol indices" << std::endl;
-    Feel::tic();
-    auto  [fo_sample, to_sample] = computeBootstrapChaosSobolIndices(X, Y, basis, total_degree, distribution, bootstrap_size);
-    Feel::toc("computeBootstrapChaosSobolIndices");
     Feel::cout << "Compute Sobol indices confidence interval" << std::endl;
     Feel::tic();
     auto [fo_interval, to_interval] = computeSobolIndicesConfidenceInterval(fo_sample, to_sample, alpha);
@@ -209,10 +316,37 @@ OT::Graph computeAndDrawSobolIndices( Results &res, OT::Sample X, OT::Sample Y,
     res.setInterval( fo_interval, 1);
     res.setInterval( to_interval, 2);
 
-    OT::Description input_names = X.getDescription();
-    OT::Graph graph = OT::SobolIndicesAlgorithm::DrawSobolIndices( input_names,
+    OT::Graph graph = OT::SobolIndicesAlgorithm::DrawSobolIndices( names,
         fo_sample.computeMean(), to_sample.computeMean(), fo_interval, to_interval);
     graph.setTitle(OT::String("Sobol indices for ") + std::to_string(N) + " samples");
 
     return graph;
 }
+
+/**
+ * @brief Compute and draw Sobol' indices from a polynomial chaos based on a given sample size
+ *
+ * @param res Result where indices are stored
+ * @param X Input design
+ * @param Y Output design
+ * @param basis Tensorized polynomial basis
+ * @param total_degree Maximum total degree of the polynomials
+ * @param distribution Distribution of X
+ * @param bootstrap_size Size of the bootstrap sample
+ * @param alpha Confidence level
+ * @param nthreads Number of threads computing the bootstrap replicates
+ * @param seed Seed of the bootstrap selections
+ * @return OT::Graph Graph of the Sobol' indices
+ */
+OT::Graph computeAndDrawSobolIndices( Results &res, OT::Sample X, OT::Sample Y, OT::OrthogonalProductPolynomialFactory basis,
+    OT::UnsignedInteger total_degree, OT::Distribution distribution, size_t bootstrap_size=500, OT::Scalar alpha = 0.95,
+    size_t nthreads = 1, std::uint64_t seed = 0)
+{
+    Feel::cout << "Compute bootstrap chaos Sobol indices" << std::endl;
+    Feel::tic();
+    auto  [fo_sample, to_sample] = computeBootstrapChaosSobolIndices(X, Y, basis, total_degree, distribution, bootstrap_size, 1e-9, nthreads, seed);
+    Feel::toc("computeBootstrapChaosSobolIndices");
+    return setAndDrawSobolIndices( res, X.getDescription(), X.getSize(), fo_sample, to_sample, alpha );
+}
+
+#endif // __FUNCTIONAL_CHAOS_HPP__
@@ -0,0 +1,207 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file MPIScheduler.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Master/worker distribution of the evaluation of a sample over MPI ranks
+//!
+
+#ifndef __MPI_SCHEDULER_HPP__
+#define __MPI_SCHEDULER_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <mpi.h>
+#include <openturns/OT.hxx>
+
+
+/**
+ * @brief Dynamic master/worker scheduler
+ *
+ * The master rank (rank 0) does not evaluate anything : it hands out chunks
+ * of the input sample to the workers on demand and gathers the outputs as
+ * they come back. The chunks shrink with the remaining work (guided
+ * scheduling), so that a slow rank does not stall the end of the sweep.
+ *
+ * Workers stay in serve() for the whole run and are released by stop().
+ * Between two calls to evaluate(), idle workers are blocked on their request.
+ */
+class MPIScheduler
+{
+public:
+    typedef std::function<void( double const*, size_t, double*, std::int64_t )> kernel_t;
+
+    /**
+     * @brief Construct a new MPIScheduler object
+     *
+     * @param comm communicator, its rank 0 is the master
+     * @param minChunk minimal number of samples sent at once to a worker
+     * @param maxChunk maximal number of samples sent at once to a worker, 0 for no limit
+     */
+    MPIScheduler( MPI_Comm comm = MPI_COMM_WORLD, size_t minChunk = 1, size_t maxChunk = 0 ) :
+        M_comm(comm), M_minChunk(std::max<size_t>(minChunk, 1)), M_maxChunk(maxChunk), M_stopped(false)
+    {
+        MPI_Comm_rank( M_comm, &M_rank );
+        MPI_Comm_size( M_comm, &M_size );
+    };
+    ~MPIScheduler() {};
+
+    // Accessors
+    bool isMaster() const { return M_rank == 0; };
+    int rank() const { return M_rank; };
+    int nWorkers() const { return M_size - 1; };
+
+    /**
+     * @brief Evaluate a sample on the workers, to be called by the master only
+     *
+     * @param input Sample of input parameters
+     * @param level value passed to the kernel of the workers along with each chunk, e.g. a fidelity level
+     * @return OT::Sample outputs, of dimension 1
+     */
+    OT::Sample evaluate( OT::Sample const& input, std::int64_t level = 0 )
+    {
+        size_t n = input.getSize();
+        size_t dim = input.getDimension();
+        double const* X = input.data();
+        std::vector<double> Y(n);
+
+        size_t next = 0, pending = 0;
+        auto dispatch = [&]( int worker )
+        {
+            if ( next >= n )
+            {
+                M_idle.push_back( worker );
+                return;
+            }
+            std::uint64_t header[3] = { next, chunkSize( n - next ), std::uint64_t( level ) };
+            MPI_Send( header, 3, MPI_UINT64_T, worker, TAG_WORK, M_comm );
+            MPI_Send( X + next*dim, header[1]*dim, MPI_DOUBLE, worker, TAG_INPUT, M_comm );
+            next += header[1];
+            ++pending;
+        };
+
+        std::vector<int> idle;
+        idle.swap( M_idle );
+        for ( int worker : idle )
+            dispatch( worker );
+
+        while ( next < n || pending > 0 )
+        {
+            std::uint64_t header[2];
+            MPI_Status status;
+            MPI_Recv( header, 2, MPI_UINT64_T, MPI_ANY_SOURCE, TAG_REQUEST, M_comm, &status );
+            int worker = status.MPI_SOURCE;
+            if ( header[1] > 0 )
+            {
+                MPI_Recv( Y.data() + header[0], header[1], MPI_DOUBLE, worker, TAG_RESULT, M_comm, MPI_STATUS_IGNORE );
+                --pending;
+            }
+            dispatch( worker );
+        }
+
+        OT::Sample output(n, 1);
+        for (size_t i = 0; i < n; ++i)
+            output(i, 0) = Y[i];
+        return output;
+    }
+
+    /**
+     * @brief Serve the requests of the master until stop() is called, to be called by the workers only
+     *
+     * @param dim dimension of the input parameters
+     * @param kernel function computing the n outputs Y of the n row-major parameters X at a level
+     */
+    void serve( size_t dim, kernel_t const& kernel )
+    {
+        std::uint64_t header[3] = { 0, 0, 0 };
+        std::vector<double> X, Y;
+        for (;;)
+        {
+            MPI_Send( header, 2, MPI_UINT64_T, 0, TAG_REQUEST, M_comm );
+            if ( header[1] > 0 )
+                MPI_Send( Y.data(), header[1], MPI_DOUBLE, 0, TAG_RESULT, M_comm );
+
+            MPI_Status status;
+            MPI_Recv( header, 3, MPI_UINT64_T, 0, MPI_ANY_TAG, M_comm, &status );
+            if ( status.MPI_TAG == TAG_EXIT )
+                break;
+            X.resize( header[1]*dim );
+            Y.resize( header[1] );
+            MPI_Recv( X.data(), header[1]*dim, MPI_DOUBLE, 0, TAG_INPUT, M_comm, MPI_STATUS_IGNORE );
+            kernel( X.data(), header[1], Y.data(), std::int64_t( header[2] ) );
+        }
+    }
+
+    /**
+     * @brief Release the workers from serve(), to be called by the master only
+     *
+     * The outputs of a chunk still in progress, if evaluate() has been left by
+     * an exception, are received and dropped. Calling it again does nothing.
+     */
+    void stop()
+    {
+        if ( M_stopped )
+            return;
+        M_stopped = true;
+        std::uint64_t header[3] = { 0, 0, 0 };
+        for ( int worker : M_idle )
+            MPI_Send( header, 3, MPI_UINT64_T, worker, TAG_EXIT, M_comm );
+        std::vector<double> Y;
+        for ( int k = M_idle.size(); k < nWorkers(); ++k )
+        {
+            MPI_Status status;
+            MPI_Recv( header, 2, MPI_UINT64_T, MPI_ANY_SOURCE, TAG_REQUEST, M_comm, &status );
+            if ( header[1] > 0 )
+            {
+                Y.resize( header[1] );
+                MPI_Recv( Y.data(), header[1], MPI_DOUBLE, status.MPI_SOURCE, TAG_RESULT, M_comm, MPI_STATUS_IGNORE );
+            }
+            MPI_Send( header, 3, MPI_UINT64_T, status.MPI_SOURCE, TAG_EXIT, M_comm );
+        }
+        M_idle.clear();
+    }
+
+private:
+    enum { TAG_REQUEST = 1, TAG_RESULT, TAG_WORK, TAG_INPUT, TAG_EXIT };
+
+    /**
+     * @brief Size of the next chunk, half of a fair share of the remaining samples
+     *
+     * @param remaining number of samples not yet sent
+     */
+    size_t chunkSize( size_t remaining ) const
+    {
+        size_t chunk = std::max( M_minChunk, remaining / ( 2 * std::max( nWorkers(), 1 ) ) );
+        if ( M_maxChunk > 0 )
+            chunk = std::min( chunk, M_maxChunk );
+        return std::min( chunk, remaining );
+    }
+
+    MPI_Comm M_comm;
+    int M_rank, M_size;
+    size_t M_minChunk, M_maxChunk;
+    std::vector<int> M_idle;
+    bool M_stopped;
+};
+
+
+#endif // __MPI_SCHEDULER_HPP__
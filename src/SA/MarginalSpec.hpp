@@ -0,0 +1,195 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file MarginalSpec.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Description of the marginals of the inputs, with the block kernels of their quantiles
+//!
+
+#ifndef __MARGINAL_SPEC_HPP__
+#define __MARGINAL_SPEC_HPP__
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <openturns/OT.hxx>
+#include "../common/RandomStreams.hpp"
+
+
+/**
+ * @brief Marginal distribution of an input, with the parameters of the families having a quantile kernel
+ *
+ * The uniform and the truncated log-normal distributions are recognized from
+ * the OpenTURNS distribution, and their quantiles are computed on blocks of
+ * probabilities by the kernels of RandomStreams.hpp, which can run on any
+ * thread. The quantiles of the other distributions are computed by OpenTURNS.
+ */
+class MarginalSpec
+{
+public:
+    enum class Kind { Uniform, TruncatedLogNormal, Generic };
+
+    /**
+     * @brief Construct a new MarginalSpec object from an OpenTURNS distribution
+     *
+     * @param distribution distribution of dimension 1
+     */
+    explicit MarginalSpec( OT::Distribution const& distribution ) :
+        M_distribution(distribution), M_kind(Kind::Generic), M_a(0), M_b(0), M_mu(0), M_sigma(0), M_gamma(0)
+    {
+        std::string name = distribution.getImplementation()->getClassName();
+        if ( name == "Uniform" )
+        {
+            OT::Point parameter = distribution.getParameter();
+            M_kind = Kind::Uniform;
+            M_a = parameter[0];
+            M_b = parameter[1];
+        }
+        else if ( name == "TruncatedDistribution" )
+        {
+            auto const* truncated = dynamic_cast<OT::TruncatedDistribution const*>( distribution.getImplementation().get() );
+            OT::Distribution untruncated = truncated->getDistribution();
+            if ( untruncated.getImplementation()->getClassName() == "LogNormal" )
+            {
+                OT::Point parameter = untruncated.getParameter();
+                OT::Interval bounds = truncated->getBounds();
+                M_kind = Kind::TruncatedLogNormal;
+                M_mu = parameter[0];
+                M_sigma = parameter[1];
+                M_gamma = parameter[2];
+                M_a = std::max( bounds.getLowerBound()[0], M_gamma );
+                M_b = bounds.getUpperBound()[0];
+            }
+        }
+    }
+
+    /**
+     * @brief Uniform distribution on [a, b]
+     */
+    static MarginalSpec uniform( std::string const& name, double a, double b )
+    {
+        OT::Distribution distribution = OT::Uniform( a, b );
+        distribution.setDescription( { name } );
+        return MarginalSpec( distribution );
+    }
+
+    /**
+     * @brief Log-normal distribution gamma + exp(mu + sigma N) truncated to [a, b]
+     */
+    static MarginalSpec truncatedLogNormal( std::string const& name, double mu, double sigma, double gamma, double a, double b )
+    {
+        OT::Distribution distribution = OT::TruncatedDistribution( OT::LogNormal( mu, sigma, gamma ), OT::Interval( a, b ) );
+        distribution.setDescription( { name } );
+        return MarginalSpec( distribution );
+    }
+
+    // Accessors
+    OT::Distribution const& distribution() const { return M_distribution; };
+    Kind kind() const { return M_kind; };
+
+    /**
+     * @brief Copy of the marginal sharing no implementation with it
+     *
+     * The uniform and truncated log-normal distributions are built again from
+     * their parameters, the other ones are cloned.
+     */
+    MarginalSpec independentCopy() const
+    {
+        std::string name = M_distribution.getDescription()[0];
+        if ( M_kind == Kind::Uniform )
+            return uniform( name, M_a, M_b );
+        if ( M_kind == Kind::TruncatedLogNormal )
+            return truncatedLogNormal( name, M_mu, M_sigma, M_gamma, M_a, M_b );
+        return MarginalSpec( OT::Distribution( M_distribution.getImplementation()->clone() ) );
+    }
+
+    /**
+     * @brief Whether the quantiles are computed by a kernel, which can run on any thread
+     */
+    bool hasKernel() const { return M_kind != Kind::Generic; }
+
+    /**
+     * @brief Quantiles of a block of probabilities
+     *
+     * Without kernel, the quantiles are computed by OpenTURNS, from the calling thread only.
+     *
+     * @param u probabilities, in (0, 1)
+     * @param n number of probabilities
+     * @param x quantiles, of size n
+     */
+    void quantile( double const* u, size_t n, double* x ) const
+    {
+        if ( M_kind == Kind::Uniform )
+            uniformQuantile( u, n, M_a, M_b, x );
+        else if ( M_kind == Kind::TruncatedLogNormal )
+            truncatedLogNormalQuantile( u, n, M_mu, M_sigma, M_gamma, M_a, M_b, x );
+        else
+        {
+            OT::Point p( n );
+            std::copy( u, u + n, p.begin() );
+            OT::Sample q = M_distribution.computeQuantile( p );
+            for (size_t k = 0; k < n; ++k)
+                x[k] = q(k, 0);
+        }
+    }
+
+private:
+    OT::Distribution M_distribution;
+    Kind M_kind;
+    double M_a, M_b;                // bounds of the support
+    double M_mu, M_sigma, M_gamma;  // parameters of the log-normal distribution
+};
+
+/**
+ * @brief Composed distribution of independent marginals
+ *
+ * @param marginals marginals of the inputs
+ * @return OT::ComposedDistribution
+ */
+inline OT::ComposedDistribution composedDistribution( std::vector<MarginalSpec> const& marginals )
+{
+    OT::Collection<OT::Distribution> distributions( marginals.size() );
+    for (size_t j = 0; j < marginals.size(); ++j)
+        distributions[j] = marginals[j].distribution();
+    return OT::ComposedDistribution( distributions );
+}
+
+/**
+ * @brief Copy of a distribution of independent marginals sharing no implementation with it
+ *
+ * A clone of an OT::ComposedDistribution shares the implementations of its
+ * marginals, and the caches they fill lazily, so that it cannot be used on
+ * another thread than the original. The marginals are built again instead.
+ *
+ * @param distribution distribution of independent marginals
+ * @return OT::Distribution
+ */
+inline OT::Distribution independentDistribution( OT::Distribution const& distribution )
+{
+    std::vector<MarginalSpec> marginals;
+    for (size_t j = 0; j < distribution.getDimension(); ++j)
+        marginals.push_back( MarginalSpec( distribution.getMarginal( j ) ).independentCopy() );
+    OT::Distribution copy = composedDistribution( marginals );
+    copy.setDescription( distribution.getDescription() );
+    return copy;
+}
+
+
+#endif // __MARGINAL_SPEC_HPP__
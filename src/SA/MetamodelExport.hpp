@@ -0,0 +1,99 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file MetamodelExport.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Conversion of a polynomial chaos of OpenTURNS to a standalone ChaosMetamodel
+//!
+
+#ifndef __METAMODEL_EXPORT_HPP__
+#define __METAMODEL_EXPORT_HPP__
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <openturns/OT.hxx>
+#include "../metamodel/ChaosMetamodel.hpp"
+
+
+/**
+ * @brief Convert a polynomial chaos to a standalone metamodel
+ *
+ * The transformation of each input to the measure of its polynomial family must
+ * be affine, which is the case when the family is the one of a standard
+ * distribution (Legendre for Uniform, Hermite for Normal, ...) or when the
+ * measure is the marginal itself (families built by AdaptiveStieltjes).
+ *
+ * @param result result of the polynomial chaos
+ * @param basis basis the chaos was built on
+ * @param distribution distribution of the inputs
+ * @return ChaosMetamodel
+ */
+inline ChaosMetamodel exportChaos( OT::FunctionalChaosResult const& result, OT::OrthogonalProductPolynomialFactory const& basis,
+                                   OT::Distribution const& distribution )
+{
+    size_t dim = distribution.getDimension();
+    OT::EnumerateFunction enumerate = basis.getEnumerateFunction();
+    OT::Indices indices = result.getIndices();
+    OT::Sample coefficients = result.getCoefficients();
+
+    std::vector<std::vector<std::uint32_t>> multiIndices( indices.getSize() );
+    std::vector<double> c( indices.getSize() );
+    std::vector<std::uint32_t> degrees( dim, 0 );
+    for (size_t t = 0; t < indices.getSize(); ++t)
+    {
+        OT::Indices alpha = enumerate( indices[t] );
+        multiIndices[t].assign( alpha.begin(), alpha.end() );
+        for (size_t j = 0; j < dim; ++j)
+            degrees[j] = std::max<std::uint32_t>( degrees[j], alpha[j] );
+        c[t] = coefficients(t, 0);
+    }
+
+    OT::Distribution measure = basis.getMeasure();
+    OT::Collection<OT::OrthogonalUniVariatePolynomialFamily> families = basis.getPolynomialFamilyCollection();
+    std::vector<ChaosMetamodel::Marginal> marginals( dim );
+    for (size_t j = 0; j < dim; ++j)
+    {
+        // affine transformation z = (x - shift) / scale, identified on three quantiles
+        OT::Distribution marginal = distribution.getMarginal( j );
+        OT::DistributionTransformation T( marginal, measure.getMarginal( j ) );
+        double x[3], z[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            x[k] = marginal.computeQuantile( 0.1 + 0.4*k )[0];
+            z[k] = T( OT::Point( 1, x[k] ) )[0];
+        }
+        double scale = ( x[2] - x[0] ) / ( z[2] - z[0] );
+        double shift = x[0] - scale * z[0];
+        if ( std::abs( shift + scale * z[1] - x[1] ) > 1e-8 * ( std::abs( x[2] - x[0] ) + 1 ) )
+            throw std::runtime_error( "exportChaos: the transformation of the input " + std::to_string(j) + " to its polynomial family is not affine" );
+        marginals[j].shift = shift;
+        marginals[j].scale = scale;
+        for (size_t k = 0; k < degrees[j]; ++k)
+        {
+            OT::Point abc = families[j].getRecurrenceCoefficients( k );
+            marginals[j].recurrence.insert( marginals[j].recurrence.end(), abc.begin(), abc.end() );
+        }
+    }
+    return ChaosMetamodel( marginals, multiIndices, c );
+}
+
+
+#endif // __METAMODEL_EXPORT_HPP__
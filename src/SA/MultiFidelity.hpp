@@ -0,0 +1,288 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file MultiFidelity.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Multi-fidelity Sobol indices, a low fidelity model being used as control variate
+//!
+
+#ifndef __MULTI_FIDELITY_HPP__
+#define __MULTI_FIDELITY_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <openturns/OT.hxx>
+
+
+/**
+ * @brief Sobol indices estimated from a pick-freeze design evaluated with two fidelities
+ *
+ * The indices are ratios of means of per-sample quantities q, computed on
+ * the base samples k of the designs [A; B; E_1; ...; E_d]:
+ *   - (yA + yB) / 2 and (yA^2 + yB^2) / 2, for the variance of the output,
+ *   - yB (yE_i - yA), for the first order indices (Saltelli 2010),
+ *   - (yA - yE_i)^2 / 2, for the total order indices (Jansen).
+ *
+ * The outputs of each fidelity are centred on the mean of its first paired
+ * outputs before computing these quantities: the indices do not change, but
+ * the sums no longer lose their significant digits when the outputs are far
+ * from 0 compared to their spread.
+ * The first N_hi base samples are evaluated with both fidelities, the other
+ * ones with the low fidelity only. Each mean is estimated with the low
+ * fidelity as control variate :
+ *   m = mean_hi(q) + alpha ( mean_lo(q_lo, N_lo) - mean_lo(q_lo, N_hi) ),
+ * alpha = cov(q, q_lo) / var(q_lo) being estimated on the paired samples.
+ * The confidence intervals come from the linearization of the indices with
+ * respect to these means (influence function of each sample).
+ */
+class MultiFidelitySobol
+{
+public:
+    /**
+     * @brief Construct a new MultiFidelitySobol object
+     *
+     * @param dim dimension of the input parameters
+     */
+    MultiFidelitySobol( size_t dim ) :
+        M_dim(dim), M_hi(2 + 2*dim), M_lo(2 + 2*dim), M_nPaired(0), M_centerHi(0), M_centerLo(0),
+        M_firstOrder(dim), M_totalOrder(dim), M_firstOrderStd(dim), M_totalOrderStd(dim)
+    {};
+
+    // Accessors
+    size_t nPaired() const { return M_nPaired; };
+    size_t nLow() const { return M_lo[0].size(); };
+    OT::Point const& firstOrder() const { return M_firstOrder; };
+    OT::Point const& totalOrder() const { return M_totalOrder; };
+
+    /**
+     * @brief Add base samples evaluated with both fidelities, before any low fidelity only sample
+     *
+     * @param yHi outputs of the high fidelity model on a pick-freeze design of n base samples
+     * @param yLo outputs of the low fidelity model on the same design
+     * @param n number of base samples of the design
+     */
+    void addPaired( OT::Sample const& yHi, OT::Sample const& yLo, size_t n )
+    {
+        if ( nLow() != M_nPaired )
+            throw std::logic_error( "MultiFidelitySobol: paired samples must be added before the low fidelity only ones" );
+        if ( M_nPaired == 0 )
+        {
+            M_centerHi = center( yHi, n );
+            M_centerLo = center( yLo, n );
+        }
+        addQuantities( M_hi, yHi, n, M_centerHi );
+        addQuantities( M_lo, yLo, n, M_centerLo );
+        M_nPaired += n;
+    }
+
+    /**
+     * @brief Add base samples evaluated with the low fidelity only
+     *
+     * @param yLo outputs of the low fidelity model on a pick-freeze design of n base samples
+     * @param n number of base samples of the design
+     */
+    void addLow( OT::Sample const& yLo, size_t n )
+    {
+        if ( M_nPaired == 0 )
+            throw std::logic_error( "MultiFidelitySobol: paired samples must be added before the low fidelity only ones" );
+        addQuantities( M_lo, yLo, n, M_centerLo );
+    }
+
+    /**
+     * @brief Ratio N_lo / N_hi minimizing the variance for a given cost (multi-fidelity Monte Carlo)
+     *
+     * @param costHi cost of an evaluation of the high fidelity model
+     * @param costLo cost of an evaluation of the low fidelity model
+     * @param rho correlation between the outputs of the two models
+     * @param maxRatio upper bound of the ratio
+     * @return double ratio, in [1, maxRatio]
+     */
+    static double sampleRatio( double costHi, double costLo, double rho, double maxRatio )
+    {
+        double rho2 = std::min( rho*rho, 1. );
+        if ( costLo <= 0 || rho2 >= 1 )
+            return maxRatio;
+        double r = std::sqrt( costHi * rho2 / ( costLo * ( 1 - rho2 ) ) );
+        return std::clamp( r, 1., std::max( maxRatio, 1. ) );
+    }
+
+    /**
+     * @brief Correlation of two samples of outputs of same size
+     */
+    static double correlation( OT::Sample const& y1, OT::Sample const& y2 )
+    {
+        std::vector<double> a( y1.getSize() ), b( y2.getSize() );
+        for (size_t k = 0; k < a.size(); ++k)
+        {
+            a[k] = y1(k, 0);
+            b[k] = y2(k, 0);
+        }
+        double var_a = covariance( a, a, a.size() ), var_b = covariance( b, b, b.size() );
+        return ( var_a > 0 && var_b > 0 ) ? covariance( a, b, a.size() ) / std::sqrt( var_a * var_b ) : 0;
+    }
+
+    /**
+     * @brief Compute the indices and the standard deviations of their estimators
+     */
+    void run()
+    {
+        size_t p = M_hi.size();
+        size_t nHi = M_nPaired, nLo = nLow();
+        if ( nHi < 2 )
+            throw std::logic_error( "MultiFidelitySobol: at least two paired samples are needed" );
+
+        // control variate estimation of the means
+        std::vector<double> m(p), alpha(p, 0.);
+        for (size_t j = 0; j < p; ++j)
+        {
+            m[j] = mean( M_hi[j], nHi );
+            if ( nLo > nHi )
+            {
+                double var_lo = covariance( M_lo[j], M_lo[j], nHi );
+                alpha[j] = var_lo > 0 ? covariance( M_hi[j], M_lo[j], nHi ) / var_lo : 0;
+                m[j] += alpha[j] * ( mean( M_lo[j], nLo ) - mean( M_lo[j], nHi ) );
+            }
+        }
+
+        double variance = m[1] - m[0]*m[0];
+        if ( variance <= 0 )
+            throw std::runtime_error( "MultiFidelitySobol: the variance of the output is not positive" );
+        for (size_t i = 0; i < M_dim; ++i)
+        {
+            M_firstOrder[i] = m[2 + i] / variance;
+            M_totalOrder[i] = m[2 + M_dim + i] / variance;
+            M_firstOrderStd[i] = std::sqrt( estimatorVariance( 2 + i, M_firstOrder[i], m, alpha, variance ) );
+            M_totalOrderStd[i] = std::sqrt( estimatorVariance( 2 + M_dim + i, M_totalOrder[i], m, alpha, variance ) );
+        }
+    }
+
+    /**
+     * @brief Asymptotic confidence intervals of the indices
+     *
+     * @param order 1 for the first order indices, else total order
+     * @param level confidence level
+     * @return OT::Interval
+     */
+    OT::Interval interval( int order, double level = 0.95 ) const
+    {
+        double z = OT::Normal().computeQuantile( 0.5 + level / 2 )[0];
+        OT::Point const& S = ( order == 1 ) ? M_firstOrder : M_totalOrder;
+        OT::Point const& sd = ( order == 1 ) ? M_firstOrderStd : M_totalOrderStd;
+        OT::Point lower( M_dim ), upper( M_dim );
+        for (size_t i = 0; i < M_dim; ++i)
+        {
+            lower[i] = S[i] - z * sd[i];
+            upper[i] = S[i] + z * sd[i];
+        }
+        return OT::Interval( lower, upper );
+    }
+
+private:
+    typedef std::vector<std::vector<double>> quantities_t;
+
+    /**
+     * @brief Mean of the outputs of the blocks A and B of a pick-freeze design
+     */
+    static double center( OT::Sample const& y, size_t n )
+    {
+        double s = 0;
+        for (size_t k = 0; k < 2*n; ++k)
+            s += y(k, 0);
+        return n > 0 ? s / ( 2*n ) : 0;
+    }
+
+    /**
+     * @brief Append the per-sample quantities of the outputs of a pick-freeze design, centred on c
+     */
+    void addQuantities( quantities_t& q, OT::Sample const& y, size_t n, double c ) const
+    {
+        if ( y.getSize() != n * ( M_dim + 2 ) )
+            throw std::invalid_argument( "MultiFidelitySobol: the outputs are not the ones of a pick-freeze design" );
+        for (size_t k = 0; k < n; ++k)
+        {
+            double yA = y(k, 0) - c, yB = y(n + k, 0) - c;
+            q[0].push_back( ( yA + yB ) / 2 );
+            q[1].push_back( ( yA*yA + yB*yB ) / 2 );
+            for (size_t i = 0; i < M_dim; ++i)
+            {
+                double yE = y((2 + i)*n + k, 0) - c;
+                q[2 + i].push_back( yB * ( yE - yA ) );
+                q[2 + M_dim + i].push_back( ( yA - yE ) * ( yA - yE ) / 2 );
+            }
+        }
+    }
+
+    static double mean( std::vector<double> const& v, size_t n )
+    {
+        double s = 0;
+        for (size_t k = 0; k < n; ++k)
+            s += v[k];
+        return s / n;
+    }
+
+    static double covariance( std::vector<double> const& a, std::vector<double> const& b, size_t n )
+    {
+        double ma = mean( a, n ), mb = mean( b, n ), s = 0;
+        for (size_t k = 0; k < n; ++k)
+            s += ( a[k] - ma ) * ( b[k] - mb );
+        return s / ( n - 1 );
+    }
+
+    /**
+     * @brief Variance of the estimator S = m_j / (m_1 - m_0^2), by the delta method
+     *
+     * The estimator is linearized with respect to the means, each of them being
+     * a sum of independent contributions of the paired and low fidelity only samples.
+     */
+    double estimatorVariance( size_t j, double S, std::vector<double> const& m, std::vector<double> const& alpha, double variance ) const
+    {
+        size_t nHi = M_nPaired, nLo = nLow();
+        // gradient of S with respect to the means m_0, m_1 and m_j
+        size_t idx[3] = { 0, 1, j };
+        double c[3] = { 2 * m[0] * S / variance, -S / variance, 1 / variance };
+
+        std::vector<double> a( nHi, 0. ), b( nLo - nHi, 0. );
+        for (int l = 0; l < 3; ++l)
+        {
+            std::vector<double> const& qHi = M_hi[idx[l]];
+            std::vector<double> const& qLo = M_lo[idx[l]];
+            double al = alpha[idx[l]];
+            for (size_t k = 0; k < nHi; ++k)
+                a[k] += c[l] * ( ( qHi[k] - al * qLo[k] ) / nHi + al * qLo[k] / nLo );
+            for (size_t k = nHi; k < nLo; ++k)
+                b[k - nHi] += c[l] * al * qLo[k] / nLo;
+        }
+        double v = nHi * covariance( a, a, nHi );
+        if ( b.size() > 1 )
+            v += b.size() * covariance( b, b, b.size() );
+        return v;
+    }
+
+    size_t M_dim;
+    quantities_t M_hi, M_lo;
+    size_t M_nPaired;
+    double M_centerHi, M_centerLo;      // means of the first paired outputs of each fidelity
+    OT::Point M_firstOrder, M_totalOrder, M_firstOrderStd, M_totalOrderStd;
+};
+
+
+#endif // __MULTI_FIDELITY_HPP__
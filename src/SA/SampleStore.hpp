@@ -0,0 +1,263 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file SampleStore.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Column-oriented memory-mapped storage of the input designs, outputs and online timings
+//!
+
+#ifndef __SAMPLE_STORE_HPP__
+#define __SAMPLE_STORE_HPP__
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <Eigen/Core>
+#include <openturns/OT.hxx>
+
+#include "../common/MappedFile.hpp"
+
+
+/**
+ * @brief Store of samples on disk, one raw file of doubles per column
+ *
+ * The directory contains x_<j>.bin for each input, y_<k>.bin for each output,
+ * time.bin for the online time of each sample (NaN when unknown), and the
+ * text file store.meta with the number of rows, the names of the inputs and
+ * the segments of rows appended by each call to the evaluator.
+ * The columns can be read directly, e.g. with numpy.memmap.
+ *
+ * Rows are first reserved, then written (possibly concurrently, on distinct
+ * rows), and finally committed, which updates store.meta : rows reserved but
+ * not committed are ignored when the store is opened again.
+ */
+class SampleStore
+{
+public:
+    typedef Eigen::Map<const Eigen::VectorXd> column_t;
+
+    /**
+     * @brief Open a store, creating it if needed
+     *
+     * @param directory directory of the store
+     * @param names names of the inputs
+     * @param nout number of outputs
+     */
+    SampleStore( std::string const& directory, std::vector<std::string> const& names, size_t nout = 1 ) :
+        M_directory(directory), M_names(names), M_nout(nout), M_size(0), M_capacity(0)
+    {
+        std::filesystem::create_directories( M_directory );
+        if ( std::filesystem::exists( metaPath() ) )
+            readMeta();
+        for (size_t j = 0; j < M_names.size(); ++j)
+            M_columns.emplace_back( columnPath( "x_" + std::to_string(j) ) );
+        for (size_t k = 0; k < M_nout; ++k)
+            M_columns.emplace_back( columnPath( "y_" + std::to_string(k) ) );
+        M_columns.emplace_back( columnPath( "time" ) );
+        M_capacity = M_columns[0].size() / sizeof(double);
+        for ( auto const& c : M_columns )
+            M_capacity = std::min( M_capacity, c.size() / sizeof(double) );
+        if ( M_capacity < M_size )
+            throw std::runtime_error( "SampleStore: columns of " + M_directory + " are shorter than its number of rows" );
+    };
+
+    // Accessors
+    std::string const& directory() const { return M_directory; };
+    size_t size() const { return M_size; };
+    size_t dimension() const { return M_names.size(); };
+    std::vector<std::pair<size_t, size_t>> const& segments() const { return M_segments; };
+
+    /**
+     * @brief Zero-copy views on the committed rows of a column
+     */
+    column_t inputColumn( size_t j ) const { return column( j ); };
+    column_t outputColumn( size_t k = 0 ) const { return column( dimension() + k ); };
+    column_t timeColumn() const { return column( dimension() + M_nout ); };
+
+    /**
+     * @brief Reserve n rows after the already reserved rows, growing the files if needed
+     *
+     * The columns must not be accessed concurrently to this call.
+     *
+     * @param n number of rows
+     * @return size_t index of the first reserved row
+     */
+    size_t reserve( size_t n )
+    {
+        size_t first = M_size + M_reserved;
+        size_t needed = first + n;
+        if ( needed > M_capacity )
+        {
+            M_capacity = std::max( needed, 2 * M_capacity );
+            for ( auto& c : M_columns )
+                c.resize( M_capacity * sizeof(double) );
+        }
+        M_reserved += n;
+        return first;
+    }
+
+    /**
+     * @brief Write n reserved rows, can be called concurrently on distinct rows
+     *
+     * @param row index of the first row
+     * @param X row-major inputs, of size n * dimension
+     * @param Y row-major outputs, of size n * nout
+     * @param T online times, of size n, or nullptr if unknown
+     * @param n number of rows
+     */
+    void write( size_t row, double const* X, double const* Y, double const* T, size_t n )
+    {
+        size_t dim = dimension();
+        for (size_t j = 0; j < dim; ++j)
+        {
+            double* c = data( j ) + row;
+            for (size_t i = 0; i < n; ++i)
+                c[i] = X[i*dim + j];
+        }
+        for (size_t k = 0; k < M_nout; ++k)
+        {
+            double* c = data( dim + k ) + row;
+            for (size_t i = 0; i < n; ++i)
+                c[i] = Y[i*M_nout + k];
+        }
+        double* c = data( dim + M_nout ) + row;
+        for (size_t i = 0; i < n; ++i)
+            c[i] = T ? T[i] : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    /**
+     * @brief Commit all the reserved rows as a new segment
+     */
+    void commit()
+    {
+        if ( M_reserved == 0 )
+            return;
+        M_segments.emplace_back( M_size, M_reserved );
+        M_size += M_reserved;
+        M_reserved = 0;
+        for ( auto& c : M_columns )
+            c.sync();
+        writeMeta();
+    }
+
+    /**
+     * @brief Append n rows as a new segment
+     */
+    void append( double const* X, double const* Y, double const* T, size_t n )
+    {
+        size_t row = reserve( n );
+        write( row, X, Y, T, n );
+        commit();
+    }
+
+    /**
+     * @brief Copy rows of the inputs into an OT::Sample, which cannot be a view on the mapped memory
+     *
+     * @param begin first row
+     * @param n number of rows
+     * @return OT::Sample
+     */
+    OT::Sample inputSample( size_t begin, size_t n ) const
+    {
+        OT::Sample X( n, dimension() );
+        for (size_t j = 0; j < dimension(); ++j)
+        {
+            column_t c = inputColumn( j );
+            for (size_t i = 0; i < n; ++i)
+                X(i, j) = c[begin + i];
+        }
+        OT::Description description( dimension() );
+        for (size_t j = 0; j < dimension(); ++j)
+            description[j] = M_names[j];
+        X.setDescription( description );
+        return X;
+    }
+
+    /**
+     * @brief Copy rows of the outputs into an OT::Sample
+     *
+     * @param begin first row
+     * @param n number of rows
+     * @return OT::Sample
+     */
+    OT::Sample outputSample( size_t begin, size_t n ) const
+    {
+        OT::Sample Y( n, M_nout );
+        for (size_t k = 0; k < M_nout; ++k)
+        {
+            column_t c = outputColumn( k );
+            for (size_t i = 0; i < n; ++i)
+                Y(i, k) = c[begin + i];
+        }
+        return Y;
+    }
+
+private:
+    std::string metaPath() const { return ( std::filesystem::path( M_directory ) / "store.meta" ).string(); }
+    std::string columnPath( std::string const& name ) const { return ( std::filesystem::path( M_directory ) / ( name + ".bin" ) ).string(); }
+    double* data( size_t c ) { return reinterpret_cast<double*>( M_columns[c].data() ); }
+    column_t column( size_t c ) const { return column_t( reinterpret_cast<double const*>( M_columns[c].data() ), M_size ); }
+
+    void readMeta()
+    {
+        std::ifstream meta( metaPath() );
+        std::string word;
+        size_t version, dim, nout, nsegments;
+        meta >> word >> version >> word >> M_size >> word >> dim;
+        std::vector<std::string> names( dim );
+        for ( auto& name : names )
+            meta >> name;
+        meta >> word >> nout >> word >> nsegments;
+        M_segments.resize( nsegments );
+        for ( auto& [begin, n] : M_segments )
+            meta >> begin >> n;
+        if ( !meta || names != M_names || nout != M_nout )
+            throw std::runtime_error( "SampleStore: " + M_directory + " stores samples of different inputs or outputs" );
+    }
+
+    void writeMeta() const
+    {
+        std::string tmp = metaPath() + ".tmp";
+        {
+            std::ofstream meta( tmp );
+            meta << "version 1\nrows " << M_size << "\ninputs " << M_names.size();
+            for ( auto const& name : M_names )
+                meta << " " << name;
+            meta << "\noutputs " << M_nout << "\nsegments " << M_segments.size() << "\n";
+            for ( auto const& [begin, n] : M_segments )
+                meta << begin << " " << n << "\n";
+        }
+        std::filesystem::rename( tmp, metaPath() );
+    }
+
+    std::string M_directory;
+    std::vector<std::string> M_names;
+    size_t M_nout, M_size, M_capacity, M_reserved = 0;
+    std::vector<std::pair<size_t, size_t>> M_segments;
+    std::vector<MappedFile> M_columns;
+};
+
+
+#endif // __SAMPLE_STORE_HPP__
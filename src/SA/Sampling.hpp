@@ -0,0 +1,424 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file Sampling.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Generation of nested designs of experiments
+//!
+
+#ifndef __SAMPLING_HPP__
+#define __SAMPLING_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <openturns/OT.hxx>
+#include "../common/ParallelFor.hpp"
+#include "../common/RandomStreams.hpp"
+#include "MarginalSpec.hpp"
+
+
+/**
+ * @brief Generator of a nested design : each call to generate returns the next points of the design
+ *
+ * Types of sampling :
+ *   - random : Monte Carlo sampling of the distribution, drawn point by point
+ *   - philox : Monte Carlo sampling whose uniform numbers are drawn from a
+ *     counter-based stream keyed by the shift of the sampler, each point only
+ *     depending on its index, so that the design does not depend on the number
+ *     of threads generating it; the quantiles of the uniform and truncated
+ *     log-normal marginals are computed by block kernels
+ *   - lhs : Latin hypercube sampling, each call drawing a new hypercube of
+ *     the requested size, so that the design is a union of hypercubes
+ *   - sobol : Sobol' sequence, randomly shifted (Cranley-Patterson rotation),
+ *     mapped through the quantile functions of the marginals
+ *   - halton : Halton sequence, randomly shifted and mapped as the Sobol' one
+ *
+ * Each sampler draws its own shift, so that independent samplers give
+ * independent replicates of a randomized quasi-Monte Carlo design.
+ * The marginals of the distribution are assumed independent.
+ */
+class Sampler
+{
+public:
+    /**
+     * @brief Construct a new Sampler object
+     *
+     * @param distribution distribution of the inputs
+     * @param type type of sampling
+     */
+    Sampler( OT::Distribution const& distribution, std::string const& type = "random" ) :
+        M_distribution(distribution), M_type(type), M_dim(distribution.getDimension()), M_size(0), M_threads(threadCount(0)), M_stateSize(0)
+    {
+        if ( isSequence() )
+        {
+            M_sequence = makeSequence();
+            M_shift = OT::RandomGenerator::Generate( M_dim );
+        }
+        else if ( M_type == "philox" )
+        {
+            for (size_t j = 0; j < M_dim; ++j)
+                M_marginals.emplace_back( M_distribution.getMarginal( j ) );
+            M_shift = OT::RandomGenerator::Generate( M_dim );
+        }
+        else if ( M_type != "random" && M_type != "lhs" )
+            throw std::invalid_argument( "Sampler: unknown type of sampling " + M_type );
+    };
+
+    // Accessors
+    std::string const& type() const { return M_type; };
+    size_t size() const { return M_size; };
+    OT::Point const& shift() const { return M_shift; };
+
+    // Mutators
+    void setThreads( size_t nthreads ) { M_threads = std::max<size_t>( nthreads, 1 ); };
+
+    /**
+     * @brief Restore the state of a sampler which has generated size points
+     *
+     * For the random and lhs samplings, a size within the last call to generate,
+     * the points after it being dropped, rewinds the random generator to its state
+     * before this call and draws size points from there again: the state is then the
+     * one of a call for the points kept, the random points being the first ones of
+     * the call. Otherwise, as on a resume, the state of the random generator must be
+     * restored separately. The random generator must not have been used since the
+     * call to generate.
+     *
+     * @param size number of points already generated
+     * @param shift shift of the sequence
+     */
+    void restore( size_t size, OT::Point const& shift )
+    {
+        if ( ( M_type == "random" || M_type == "lhs" ) && size >= M_stateSize && size < M_size )
+        {
+            OT::RandomGenerator::SetState( M_state );
+            M_size = M_stateSize;
+            generate( size - M_stateSize );
+        }
+        M_size = size;
+        if ( isSequence() )
+        {
+            M_sequence = makeSequence();
+            if ( size > 0 )
+                M_sequence.generate( size );
+            M_shift = shift;
+        }
+        else if ( M_type == "philox" )
+            M_shift = shift;
+    }
+
+    /**
+     * @brief Generate the next points of the design
+     *
+     * @param n number of points to generate
+     * @return OT::Sample
+     */
+    OT::Sample generate( size_t n )
+    {
+        M_state = OT::RandomGenerator::GetState();
+        M_stateSize = M_size;
+        M_size += n;
+        if ( M_type == "random" )
+        {
+            // point by point, so that the first points do not depend on n
+            OT::Sample x( n, M_dim );
+            for (size_t i = 0; i < n; ++i)
+                x[i] = M_distribution.getRealization();
+            x.setDescription( M_distribution.getDescription() );
+            return x;
+        }
+        if ( M_type == "philox" )
+            return generateStream( M_size - n, n );
+        if ( M_type == "lhs" )
+        {
+            OT::Sample x = OT::LHSExperiment( M_distribution, n ).generate();
+            x.setDescription( M_distribution.getDescription() );
+            return x;
+        }
+
+        OT::Sample u = M_sequence.generate( n );
+        OT::Sample x( n, M_dim );
+        for (size_t j = 0; j < M_dim; ++j)
+        {
+            OT::Point p( n );
+            for (size_t i = 0; i < n; ++i)
+            {
+                p[i] = u(i, j) + M_shift[j];
+                if ( p[i] >= 1 )
+                    p[i] -= 1;
+            }
+            OT::Sample q = M_distribution.getMarginal( j ).computeQuantile( p );
+            for (size_t i = 0; i < n; ++i)
+                x(i, j) = q(i, 0);
+        }
+        x.setDescription( M_distribution.getDescription() );
+        return x;
+    }
+
+private:
+    bool isSequence() const { return M_type == "sobol" || M_type == "halton"; }
+
+    OT::LowDiscrepancySequence makeSequence() const
+    {
+        if ( M_type == "halton" )
+            return OT::HaltonSequence( M_dim );
+        return OT::SobolSequence( M_dim );
+    }
+
+    /**
+     * @brief Key of the counter-based stream, mixing the bits of the shift
+     */
+    std::uint64_t streamKey() const
+    {
+        std::uint64_t key = 0;
+        for (size_t j = 0; j < M_shift.getDimension(); ++j)
+        {
+            std::uint64_t bits;
+            double v = M_shift[j];
+            std::memcpy( &bits, &v, sizeof bits );
+            // splitmix64 finalizer
+            key = ( key ^ bits ) + 0x9E3779B97F4A7C15ull;
+            key = ( key ^ ( key >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+            key = ( key ^ ( key >> 27 ) ) * 0x94D049BB133111EBull;
+            key ^= key >> 31;
+        }
+        return key;
+    }
+
+    /**
+     * @brief Points [first, first + n) of the counter-based stream
+     *
+     * The rows are split in blocks over the threads, the uniform numbers of a
+     * block being generated by columns and mapped by the kernels of the marginals;
+     * the marginals without kernel are mapped afterwards on the calling thread.
+     */
+    OT::Sample generateStream( size_t first, size_t n ) const
+    {
+        OT::Sample x( n, M_dim );
+        x.setDescription( M_distribution.getDescription() );
+        if ( n == 0 )
+            return x;
+        double* X = &x(0, 0);
+        Philox philox( streamKey() );
+        auto uniforms = [&]( size_t begin, size_t end, std::vector<double>& u ) {
+            size_t m = end - begin;
+            u.resize( m * ( M_dim + 1 ) );
+            double pair[2];
+            for (size_t k = 0; k < m; ++k)
+                for (size_t j = 0; j < M_dim; j += 2)
+                {
+                    philox.uniform( first + begin + k, j / 2, pair );
+                    u[j*m + k] = pair[0];
+                    u[(j + 1)*m + k] = pair[1];
+                }
+        };
+
+        parallelFor( n, M_threads, 4096, [&]( size_t, size_t begin, size_t end ) {
+            size_t m = end - begin;
+            std::vector<double> u, q( m );
+            uniforms( begin, end, u );
+            for (size_t j = 0; j < M_dim; ++j)
+            {
+                if ( !M_marginals[j].hasKernel() )
+                    continue;
+                M_marginals[j].quantile( u.data() + j*m, m, q.data() );
+                for (size_t k = 0; k < m; ++k)
+                    X[(begin + k)*M_dim + j] = q[k];
+            }
+        } );
+
+        std::vector<double> u, q;
+        for (size_t j = 0; j < M_dim; ++j)
+        {
+            if ( M_marginals[j].hasKernel() )
+                continue;
+            if ( u.empty() )
+            {
+                uniforms( 0, n, u );
+                q.resize( n );
+            }
+            M_marginals[j].quantile( u.data() + j*n, n, q.data() );
+            for (size_t i = 0; i < n; ++i)
+                X[i*M_dim + j] = q[i];
+        }
+        return x;
+    }
+
+    OT::Distribution M_distribution;
+    std::string M_type;
+    size_t M_dim, M_size, M_threads;
+    OT::RandomGeneratorState M_state;   // state of the random generator before the last call to generate
+    size_t M_stateSize;                 // number of points generated before the last call to generate
+    std::vector<MarginalSpec> M_marginals;
+    OT::LowDiscrepancySequence M_sequence;
+    OT::Point M_shift;
+};
+
+/**
+ * @brief Monte Carlo sample drawn with a given seed, the state of the random generator being left unchanged
+ *
+ * The sample is the same from one run to the other, so that its outputs can be served by the cache.
+ *
+ * @param distribution distribution of the inputs
+ * @param n size of the sample
+ * @param seed seed of the random generator
+ * @return OT::Sample
+ */
+inline OT::Sample reproducibleSample( OT::Distribution const& distribution, size_t n, OT::UnsignedInteger seed )
+{
+    OT::RandomGeneratorState state = OT::RandomGenerator::GetState();
+    OT::RandomGenerator::SetSeed( seed );
+    OT::Sample sample = distribution.getSample( n );
+    OT::RandomGenerator::SetState( state );
+    return sample;
+}
+
+/**
+ * @brief Pick-freeze design of the Saltelli estimators
+ *
+ * The design is [A; B; E_1; ...; E_d], E_i being A with its i-th column taken from B,
+ * i.e. the layout of OT::SobolIndicesExperiment without second order.
+ * For the second order indices, the blocks C_1, ..., C_d are appended, C_i being
+ * B with its i-th column taken from A, which reuses all the first order evaluations.
+ *
+ * @param A first independent sample
+ * @param B second independent sample, of same size and dimension as A
+ * @param secondOrder if true, append the blocks C_i of the second order indices
+ * @return OT::Sample design of size N * (d + 2), or N * (2d + 2) with second order
+ */
+inline OT::Sample pickFreezeDesign( OT::Sample const& A, OT::Sample const& B, bool secondOrder = false )
+{
+    size_t n = A.getSize();
+    size_t dim = A.getDimension();
+    OT::Sample design( A );
+    design.add( B );
+    for (size_t i = 0; i < dim; ++i)
+    {
+        OT::Sample E( A );
+        for (size_t k = 0; k < n; ++k)
+            E(k, i) = B(k, i);
+        design.add( E );
+    }
+    if ( secondOrder )
+        for (size_t i = 0; i < dim; ++i)
+        {
+            OT::Sample C( B );
+            for (size_t k = 0; k < n; ++k)
+                C(k, i) = A(k, i);
+            design.add( C );
+        }
+    return design;
+}
+
+/**
+ * @brief Merge pick-freeze designs generated one after the other into a single design
+ *
+ * The designs of sizes[k] base samples are concatenated, each one made of the
+ * same number of blocks [A; B; E_1; ...]. The blocks of the designs are gathered
+ * so that the result has the layout of a single design of sum(sizes) base samples.
+ * This applies to the inputs as well as to the outputs of the designs.
+ *
+ * @param designs concatenation of the designs
+ * @param sizes number of base samples of each design
+ * @param blocks number of blocks of each design, d + 2 or 2d + 2
+ * @return OT::Sample
+ */
+inline OT::Sample mergePickFreezeDesigns( OT::Sample const& designs, std::vector<size_t> const& sizes, size_t blocks )
+{
+    size_t n = std::accumulate( sizes.begin(), sizes.end(), size_t(0) );
+    if ( designs.getSize() != n * blocks )
+        throw std::invalid_argument( "mergePickFreezeDesigns: the size of the designs does not match the sizes of the batches" );
+    if ( sizes.size() == 1 )
+        return designs;
+    OT::Sample merged( 0, designs.getDimension() );
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        size_t begin = 0;
+        for (size_t m : sizes)
+        {
+            merged.add( OT::Sample( designs, begin + b*m, begin + (b + 1)*m ) );
+            begin += m * blocks;
+        }
+    }
+    merged.setDescription( designs.getDescription() );
+    return merged;
+}
+
+/**
+ * @brief Distribution of dimension 2d made of two copies of the marginals of a distribution
+ *
+ * Its samples are the concatenation [A, B] of two independent samples of the distribution.
+ *
+ * @param distribution distribution of the inputs, of dimension d
+ * @return OT::ComposedDistribution
+ */
+inline OT::ComposedDistribution doubledDistribution( OT::Distribution const& distribution )
+{
+    size_t dim = distribution.getDimension();
+    OT::Collection<OT::Distribution> marginals( 2*dim );
+    for (size_t j = 0; j < dim; ++j)
+        marginals[j] = marginals[dim + j] = distribution.getMarginal( j );
+    return OT::ComposedDistribution( marginals );
+}
+
+/**
+ * @brief Pick-freeze design from a sample [A, B] of dimension 2d
+ *
+ * @param AB sample of the doubled distribution
+ * @param secondOrder if true, append the blocks C_i of the second order indices
+ * @return OT::Sample design [A; B; E_1; ...; E_d], of size n * (d + 2), followed by [C_1; ...; C_d] with second order
+ */
+inline OT::Sample pickFreezeDesign( OT::Sample const& AB, bool secondOrder = false )
+{
+    size_t dim = AB.getDimension() / 2;
+    OT::Indices first( dim ), second( dim );
+    for (size_t j = 0; j < dim; ++j)
+    {
+        first[j] = j;
+        second[j] = dim + j;
+    }
+    return pickFreezeDesign( AB.getMarginal( first ), AB.getMarginal( second ), secondOrder );
+}
+
+/**
+ * @brief Pick-freeze design whose base samples A and B are drawn jointly from a sampler of dimension 2d
+ *
+ * For the quasi-Monte Carlo samplers, A and B are the two halves of the points
+ * of a sequence of dimension 2d, so that they are not correlated.
+ *
+ * @param distribution distribution of the inputs, of dimension d
+ * @param n number of base samples
+ * @param type type of sampling, see Sampler
+ * @param secondOrder if true, append the blocks C_i of the second order indices
+ * @return OT::Sample design of size n * (d + 2), or n * (2d + 2) with second order
+ */
+inline OT::Sample saltelliDesign( OT::Distribution const& distribution, size_t n, std::string const& type, bool secondOrder = false )
+{
+    Sampler sampler( doubledDistribution( distribution ), type );
+    OT::Sample design = pickFreezeDesign( sampler.generate( n ), secondOrder );
+    design.setDescription( distribution.getDescription() );
+    return design;
+}
+
+
+#endif // __SAMPLING_HPP__
@@ -0,0 +1,173 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file StreamingChaos.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Least squares polynomial chaos updated one sample at a time
+//!
+
+#ifndef __STREAMING_CHAOS_HPP__
+#define __STREAMING_CHAOS_HPP__
+
+#include <cmath>
+#include <tuple>
+#include <vector>
+#include <Eigen/Dense>
+#include <openturns/OT.hxx>
+#include "ChaosDesignMatrix.hpp"
+
+
+/**
+ * @brief Least squares chaos on all the terms of a basis, whose factorization is updated as the samples arrive
+ *
+ * The triangular factor R of the QR factorization of the design matrix and Q^T y
+ * are updated by Givens rotations for each new row, so that the memory is
+ * O(P^2) whatever the number of samples, and the coefficients and the Sobol
+ * indices are available at any time by a triangular solve.
+ */
+class StreamingChaos
+{
+public:
+    /**
+     * @brief Construct a new StreamingChaos object
+     *
+     * @param distribution distribution of the inputs
+     * @param basis orthonormal polynomial basis
+     * @param total_degree maximal total degree of the polynomials
+     */
+    StreamingChaos( OT::Distribution const& distribution, OT::OrthogonalProductPolynomialFactory const& basis,
+                    OT::UnsignedInteger total_degree ) :
+        M_transformation(distribution, basis.getMeasure()),
+        M_size(0),
+        M_residual(0)
+    {
+        OT::EnumerateFunction enumerate = basis.getEnumerateFunction();
+        size_t P = enumerate.getBasisSizeFromTotalDegree( total_degree );
+        M_functions.resize( P );
+        M_multiIndices.resize( P );
+        M_support.resize( P );
+        for (size_t j = 0; j < P; ++j)
+        {
+            M_functions[j] = basis.build( j );
+            M_multiIndices[j] = enumerate( j );
+            M_support[j] = j;
+        }
+        M_R = Eigen::MatrixXd::Zero( P, P );
+        M_z = Eigen::VectorXd::Zero( P );
+    }
+
+    // Accessors
+    size_t size() const { return M_size; };
+    size_t basisSize() const { return M_functions.size(); };
+
+    /**
+     * @brief Whether the least squares problem has more samples than terms
+     */
+    bool ready() const { return M_size > basisSize(); }
+
+    /**
+     * @brief Fold new samples into the factorization
+     *
+     * @param X inputs of the new samples
+     * @param Y outputs of the new samples
+     */
+    void add( OT::Sample const& X, OT::Sample const& Y )
+    {
+        size_t m = X.getSize(), P = basisSize();
+        if ( m == 0 )
+            return;
+        OT::Sample Z = M_transformation( X );
+        Eigen::MatrixXd psi( m, P );
+        for (size_t j = 0; j < P; ++j)
+        {
+            OT::Sample values = M_functions[j]( Z );
+            for (size_t k = 0; k < m; ++k)
+                psi(k, j) = values(k, 0);
+        }
+        Eigen::VectorXd v( P );
+        for (size_t k = 0; k < m; ++k)
+        {
+            v = psi.row(k).transpose();
+            double y = Y(k, 0);
+            for (size_t i = 0; i < P; ++i)
+            {
+                if ( v[i] == 0 )
+                    continue;
+                // rotation zeroing v[i] against the diagonal of R
+                double r = std::hypot( M_R(i, i), v[i] );
+                double c = M_R(i, i) / r, s = v[i] / r;
+                M_R(i, i) = r;
+                for (size_t j = i + 1; j < P; ++j)
+                {
+                    double rij = M_R(i, j);
+                    M_R(i, j) = c * rij + s * v[j];
+                    v[j] = c * v[j] - s * rij;
+                }
+                double zi = M_z[i];
+                M_z[i] = c * zi + s * y;
+                y = c * y - s * zi;
+            }
+            M_residual += y * y;
+        }
+        M_size += m;
+    }
+
+    /**
+     * @brief Least squares coefficients of the terms of the basis
+     *
+     * @throw std::logic_error if there are not more samples than terms
+     */
+    Eigen::VectorXd coefficients() const
+    {
+        if ( !ready() )
+            throw std::logic_error( "StreamingChaos: " + std::to_string( M_size ) + " sample(s) for "
+                                    + std::to_string( basisSize() ) + " terms" );
+        return M_R.triangularView<Eigen::Upper>().solve( M_z );
+    }
+
+    /**
+     * @brief Mean squared residual of the least squares fit on the samples folded so far
+     */
+    double residual() const { return M_size > 0 ? M_residual / M_size : 0; }
+
+    /**
+     * @brief First and total order Sobol indices of the current chaos
+     *
+     * @return tuple of first and total order indices
+     * @throw std::logic_error if there are not more samples than terms
+     */
+    std::tuple<OT::Point, OT::Point> sobolIndices() const
+    {
+        return chaosSobolIndices( coefficients(), M_multiIndices, M_support );
+    }
+
+private:
+    OT::DistributionTransformation M_transformation;
+    std::vector<OT::Function> M_functions;
+    std::vector<OT::Indices> M_multiIndices;
+    std::vector<size_t> M_support;
+    Eigen::MatrixXd M_R;        // upper triangular factor of the design matrix
+    Eigen::VectorXd M_z;        // Q^T y
+    size_t M_size;
+    double M_residual;          // sum of the squared residuals
+};
+
+
+#endif // __STREAMING_CHAOS_HPP__
@@ -0,0 +1,288 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file StreamingSobol.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief One-pass estimation of the Sobol indices from blocks of a pick-freeze design
+//!
+
+#ifndef __STREAMING_SOBOL_HPP__
+#define __STREAMING_SOBOL_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <openturns/OT.hxx>
+
+
+/**
+ * @brief Sobol indices computed from running sums, in O(d) memory
+ *
+ * The outputs of each block of m base samples are given in the layout of
+ * the pick-freeze design [A; B; E_1; ...; E_d], E_i being A with its i-th
+ * column taken from B. The outputs are centered by the mean of yA on the
+ * first block, which keeps the sums of squares accurate for outputs with a
+ * large mean.
+ *
+ * Estimators (a = yA, b = yB, e = yE_i, V the variance of the output):
+ *   - saltelli : S_i = mean(b (e - a)) / V, ST_i = mean(a (a - e)) / V
+ *   - jansen : S_i = 1 - mean((b - e)^2) / 2V, ST_i = mean((a - e)^2) / 2V
+ *   - martinez : S_i = corr(b, e), ST_i = 1 - corr(a, e)
+ *
+ * The intervals of the saltelli and jansen estimators come from the delta
+ * method applied to the ratio of means, those of the martinez estimator
+ * from the Fisher transform of the correlation.
+ */
+class StreamingSobol
+{
+public:
+    /**
+     * @brief Construct a new StreamingSobol object
+     *
+     * @param dim dimension of the input parameters
+     */
+    StreamingSobol( size_t dim ) :
+        M_dim(dim), M_state(NGLOBAL + dim * NINDEX, 0.)
+    {};
+
+    // Accessors
+    size_t size() const { return M_state[N]; };
+    size_t dimension() const { return M_dim; };
+
+    /**
+     * @brief State of the running sums, to be saved in a checkpoint
+     */
+    OT::Point state() const
+    {
+        OT::Point p( M_state.size() );
+        std::copy( M_state.begin(), M_state.end(), p.begin() );
+        return p;
+    }
+
+    /**
+     * @brief Restore the running sums from a state
+     */
+    void setState( OT::Point const& state )
+    {
+        if ( state.getDimension() != M_state.size() )
+            throw std::invalid_argument( "StreamingSobol: state of a different dimension" );
+        std::copy( state.begin(), state.end(), M_state.begin() );
+    }
+
+    /**
+     * @brief Fold the outputs of a block of the pick-freeze design into the running sums
+     *
+     * @param y outputs of the design [A; B; E_1; ...; E_d], of size m * (d + 2)
+     * @param m number of base samples of the block
+     */
+    void add( double const* y, size_t m )
+    {
+        if ( m == 0 )
+            return;
+        double const* yA = y;
+        double const* yB = y + m;
+        if ( size() == 0 )
+        {
+            double c = 0;
+            for (size_t k = 0; k < m; ++k)
+                c += yA[k];
+            M_state[SHIFT] = c / m;
+        }
+        double c = M_state[SHIFT];
+
+        // sums of the block, added to the running sums afterwards; the loops are vectorized
+        // through their omp simd pragmas, the target being compiled with -fopenmp-simd
+        double su = 0, sw = 0, suu = 0, sww = 0, suw = 0, sa = 0, sb = 0, saa = 0, sbb = 0;
+#pragma omp simd reduction(+:su,sw,suu,sww,suw,sa,sb,saa,sbb)
+        for (size_t k = 0; k < m; ++k)
+        {
+            double a = yA[k] - c, b = yB[k] - c;
+            double u = ( a + b ) / 2, w = ( a*a + b*b ) / 2;
+            su += u; sw += w; suu += u*u; sww += w*w; suw += u*w;
+            sa += a; sb += b; saa += a*a; sbb += b*b;
+        }
+        double global[NGLOBAL - 2] = { su, sw, suu, sww, suw, sa, sb, saa, sbb };
+        for (size_t j = 0; j < NGLOBAL - 2; ++j)
+            M_state[2 + j] += global[j];
+        M_state[N] += m;
+
+        for (size_t i = 0; i < M_dim; ++i)
+        {
+            double const* yE = y + ( 2 + i ) * m;
+            double se = 0, see = 0, sae = 0, sbe = 0;
+            double g0 = 0, g0g = 0, g0u = 0, g0w = 0, g1 = 0, g1g = 0, g1u = 0, g1w = 0;
+            double g2 = 0, g2g = 0, g2u = 0, g2w = 0, g3 = 0, g3g = 0, g3u = 0, g3w = 0;
+#pragma omp simd reduction(+:se,see,sae,sbe,g0,g0g,g0u,g0w,g1,g1g,g1u,g1w,g2,g2g,g2u,g2w,g3,g3g,g3u,g3w)
+            for (size_t k = 0; k < m; ++k)
+            {
+                double a = yA[k] - c, b = yB[k] - c, e = yE[k] - c;
+                double u = ( a + b ) / 2, w = ( a*a + b*b ) / 2;
+                se += e; see += e*e; sae += a*e; sbe += b*e;
+                double q0 = b * ( e - a ), q1 = a * ( a - e ), q2 = ( b - e ) * ( b - e ) / 2, q3 = ( a - e ) * ( a - e ) / 2;
+                g0 += q0; g0g += q0*q0; g0u += q0*u; g0w += q0*w;
+                g1 += q1; g1g += q1*q1; g1u += q1*u; g1w += q1*w;
+                g2 += q2; g2g += q2*q2; g2u += q2*u; g2w += q2*w;
+                g3 += q3; g3g += q3*q3; g3u += q3*u; g3w += q3*w;
+            }
+            double local[NINDEX] = { se, see, sae, sbe, g0, g0g, g0u, g0w, g1, g1g, g1u, g1w, g2, g2g, g2u, g2w, g3, g3g, g3u, g3w };
+            double* s = index( i );
+            for (size_t j = 0; j < NINDEX; ++j)
+                s[j] += local[j];
+        }
+    }
+
+    /**
+     * @brief First order indices
+     *
+     * @param estimator saltelli, jansen or martinez
+     */
+    OT::Point firstOrder( std::string const& estimator ) const { return indices( estimator, 1 ); }
+
+    /**
+     * @brief Total order indices
+     *
+     * @param estimator saltelli, jansen or martinez
+     */
+    OT::Point totalOrder( std::string const& estimator ) const { return indices( estimator, 2 ); }
+
+    /**
+     * @brief Asymptotic confidence intervals of the indices
+     *
+     * @param estimator saltelli, jansen or martinez
+     * @param order 1 for the first order indices, else total order
+     * @param level confidence level
+     * @return OT::Interval
+     */
+    OT::Interval interval( std::string const& estimator, int order, double level = 0.95 ) const
+    {
+        double n = size();
+        double z = OT::Normal().computeQuantile( 0.5 + level / 2 )[0];
+        OT::Point S = indices( estimator, order );
+        OT::Point lower( M_dim ), upper( M_dim );
+        for (size_t i = 0; i < M_dim; ++i)
+        {
+            if ( estimator == "martinez" )
+            {
+                // Fisher transform of the correlation rho, S = rho or 1 - rho
+                double rho = ( order == 1 ) ? S[i] : 1 - S[i];
+                double zr = std::atanh( std::clamp( rho, -1 + 1e-15, 1 - 1e-15 ) ), h = z / std::sqrt( n - 3 );
+                double lo = std::tanh( zr - h ), up = std::tanh( zr + h );
+                lower[i] = ( order == 1 ) ? lo : 1 - up;
+                upper[i] = ( order == 1 ) ? up : 1 - lo;
+            }
+            else
+            {
+                double sd = std::sqrt( ratioVariance( i, quantity( estimator, order ) ) / n );
+                lower[i] = S[i] - z * sd;
+                upper[i] = S[i] + z * sd;
+            }
+        }
+        return OT::Interval( lower, upper );
+    }
+
+private:
+    // global sums : n, shift, then sums of u, w, u^2, w^2, uw, a, b, a^2, b^2
+    enum { N = 0, SHIFT, SU, SW, SUU, SWW, SUW, SA, SB, SAA, SBB, NGLOBAL };
+    // sums per index : e, e^2, ae, be, then g, g^2, gu, gw for each of the NG quantities g
+    enum { SE = 0, SEE, SAE, SBE, SG, NG = 4, NINDEX = SG + 4 * NG };
+
+    double* index( size_t i ) { return M_state.data() + NGLOBAL + i * NINDEX; }
+    double const* index( size_t i ) const { return M_state.data() + NGLOBAL + i * NINDEX; }
+
+    /**
+     * @brief Quantity g whose mean over the variance gives the index
+     *
+     * 0 : b (e - a), 1 : a (a - e), 2 : (b - e)^2 / 2, 3 : (a - e)^2 / 2
+     */
+    static int quantity( std::string const& estimator, int order )
+    {
+        if ( estimator == "saltelli" )
+            return order == 1 ? 0 : 1;
+        if ( estimator == "jansen" )
+            return order == 1 ? 2 : 3;
+        throw std::invalid_argument( "StreamingSobol: unknown estimator " + estimator );
+    }
+
+    double variance() const
+    {
+        double n = size();
+        double mu = M_state[SU] / n, mw = M_state[SW] / n;
+        return mw - mu*mu;
+    }
+
+    OT::Point indices( std::string const& estimator, int order ) const
+    {
+        if ( size() < 2 )
+            throw std::logic_error( "StreamingSobol: at least two samples are needed" );
+        double n = size();
+        OT::Point S( M_dim );
+        for (size_t i = 0; i < M_dim; ++i)
+        {
+            double const* s = index( i );
+            if ( estimator == "martinez" )
+            {
+                double x = M_state[order == 1 ? SB : SA] / n, xx = M_state[order == 1 ? SBB : SAA] / n;
+                double me = s[SE] / n;
+                double cov = s[order == 1 ? SBE : SAE] / n - x * me;
+                double rho = cov / std::sqrt( ( xx - x*x ) * ( s[SEE] / n - me*me ) );
+                S[i] = ( order == 1 ) ? rho : 1 - rho;
+            }
+            else
+            {
+                int q = quantity( estimator, order );
+                double R = s[SG + 4*q] / n / variance();
+                S[i] = ( q == 2 ) ? 1 - R : R;
+            }
+        }
+        return S;
+    }
+
+    /**
+     * @brief Asymptotic variance of sqrt(n) R, R = mean(g) / (mean(w) - mean(u)^2), by the delta method
+     */
+    double ratioVariance( size_t i, int q ) const
+    {
+        double n = size();
+        double const* s = index( i ) + SG + 4*q;
+        double mg = s[0] / n, mu = M_state[SU] / n, mw = M_state[SW] / n;
+        double V = variance(), R = mg / V;
+        double grad[3] = { 1 / V, 2 * mu * R / V, -R / V };
+        double C[3][3];
+        C[0][0] = s[1] / n - mg*mg;
+        C[0][1] = C[1][0] = s[2] / n - mg*mu;
+        C[0][2] = C[2][0] = s[3] / n - mg*mw;
+        C[1][1] = M_state[SUU] / n - mu*mu;
+        C[1][2] = C[2][1] = M_state[SUW] / n - mu*mw;
+        C[2][2] = M_state[SWW] / n - mw*mw;
+        double v = 0;
+        for (int k = 0; k < 3; ++k)
+            for (int l = 0; l < 3; ++l)
+                v += grad[k] * C[k][l] * grad[l];
+        return v;
+    }
+
+    size_t M_dim;
+    std::vector<double> M_state;
+};
+
+
+#endif // __STREAMING_SOBOL_HPP__
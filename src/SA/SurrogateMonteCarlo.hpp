@@ -0,0 +1,90 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file SurrogateMonteCarlo.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Monte Carlo estimation of the Sobol indices on a polynomial chaos metamodel
+//!
+
+#ifndef __SURROGATE_MONTE_CARLO_HPP__
+#define __SURROGATE_MONTE_CARLO_HPP__
+
+#include <algorithm>
+#include <vector>
+#include <openturns/OT.hxx>
+#include "../metamodel/ChaosBatchKernel.hpp"
+#include "../common/ParallelFor.hpp"
+#include "Sampling.hpp"
+#include "StreamingSobol.hpp"
+
+
+/**
+ * @brief Fold the pick-freeze design of the metamodel into streaming sums, up to a number of base samples
+ *
+ * Each block of base samples is drawn from the counter-based stream of a philox
+ * sampler on nthreads threads, written in structure-of-arrays layout, the rows
+ * of the design being [A; B; E_1; ...; E_d] as in pickFreezeDesign, and evaluated
+ * by the batch kernel on nthreads threads: only one block is in memory at once,
+ * and the design does not depend on the number of threads nor on the size of the blocks.
+ *
+ * @param kernel batch kernel of the metamodel
+ * @param distribution distribution of the inputs
+ * @param size number of base samples
+ * @param block_size number of base samples of each block
+ * @param nthreads number of threads generating the design and evaluating the metamodel
+ * @param sobol running sums, completed up to size base samples
+ */
+inline void surrogateSobol( ChaosBatchKernel const& kernel, OT::Distribution const& distribution, size_t size,
+                            size_t block_size, size_t nthreads, StreamingSobol& sobol )
+{
+    size_t dim = distribution.getDimension();
+    Sampler sampler( doubledDistribution( distribution ), "philox" );
+    sampler.setThreads( nthreads );
+    std::vector<double> X, Y;
+    while ( sobol.size() < size )
+    {
+        size_t m = std::min( block_size, size - sobol.size() );
+        OT::Sample AB = sampler.generate( m );
+        double const* ab = &AB(0, 0);       // rows of 2 dim values
+        size_t rows = ( dim + 2 ) * m;
+        X.resize( dim * rows );
+        Y.resize( rows );
+        parallelFor( m, nthreads, 1024, [&]( size_t, size_t begin, size_t end ) {
+            for (size_t j = 0; j < dim; ++j)
+            {
+                double* x = X.data() + j * rows;
+                for (size_t k = begin; k < end; ++k)
+                {
+                    double a = ab[k * 2 * dim + j], b = ab[k * 2 * dim + dim + j];
+                    x[k] = a;
+                    x[m + k] = b;
+                    for (size_t i = 0; i < dim; ++i)
+                        x[( 2 + i ) * m + k] = ( i == j ) ? b : a;
+                }
+            }
+        } );
+        parallelFor( rows, nthreads, 16 * ChaosBatchKernel::block, [&]( size_t, size_t begin, size_t end ) {
+            kernel.evaluate( X.data() + begin, rows, end - begin, Y.data() + begin );
+        } );
+        sobol.add( Y.data(), m );
+    }
+}
+
+#endif // __SURROGATE_MONTE_CARLO_HPP__
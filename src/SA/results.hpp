@@ -7,7 +7,7 @@
 #include <openturns/OT.hxx>
 #include <string>
 #include <algorithm>
-#include <algorithm>
+#include <cmath>
 // #include <feel/feel.hpp>
 
 
@@ -24,14 +24,10 @@ public:
      */
     Results( size_t dim, const std::vector<std::string>& names, std::string algo, size_t size ) :
         M_dim(dim), M_names(names), M_algo(algo), M_size(size),
-        M_firstOrder(dim), M_totalOrder(dim), M_firstOrderMin(dim), M_firstOrderMax(dim), M_totalOrderMin(dim), M_totalOrderMax(dim)
+        M_firstOrder(dim), M_totalOrder(dim), M_firstOrderMin(dim), M_firstOrderMax(dim), M_totalOrderMin(dim), M_totalOrderMax(dim),
+        M_firstOrderM2(dim), M_totalOrderM2(dim), M_firstOrderCount(dim), M_totalOrderCount(dim)
     {
-        std::fill(M_firstOrder.begin(), M_firstOrder.end(), 0.0);
-        std::fill(M_totalOrder.begin(), M_totalOrder.end(), 0.0);
-        std::fill(M_firstOrderMin.begin(), M_firstOrderMin.end(), 1.0);
-        std::fill(M_totalOrderMin.begin(), M_totalOrderMin.end(), 1.0);
-        std::fill(M_firstOrderMax.begin(), M_firstOrderMax.end(), 0.0);
-        std::fill(M_totalOrderMax.begin(), M_totalOrderMax.end(), 0.0);
+        reset();
     };
     ~Results() {};
 
@@ -49,12 +45,39 @@ public:
     std::vector<OT::Scalar> getTotalOrderMin() const { return M_totalOrderMin; };
     std::vector<OT::Scalar> getFirstOrderMax() const { return M_firstOrderMax; };
     std::vector<OT::Scalar> getTotalOrderMax() const { return M_totalOrderMax; };
+    OT::Scalar maxIntervalWidth() const
+    {
+        OT::Scalar width = 0;
+        for (size_t i = 0; i < M_dim; ++i)
+            width = std::max( { width, M_firstOrderMax[i] - M_firstOrderMin[i], M_totalOrderMax[i] - M_totalOrderMin[i] } );
+        return width;
+    }
+    bool hasSecondOrder() const { return !M_secondOrder.empty(); };
+    OT::Scalar getSecondOrder( size_t i, size_t j ) const { return M_secondOrder[i*M_dim + j]; };
+
+    /**
+     * @brief Standard deviations of the replicates of the indices added by setIndice
+     *
+     * @param order order of the indices (1 for order 1, else total order)
+     */
+    OT::Point getStandardDeviation( int order ) const
+    {
+        std::vector<OT::Scalar> const& M2 = order == 1 ? M_firstOrderM2 : M_totalOrderM2;
+        std::vector<size_t> const& count = order == 1 ? M_firstOrderCount : M_totalOrderCount;
+        OT::Point deviation( M_dim );
+        for (size_t i = 0; i < M_dim; ++i)
+            deviation[i] = count[i] > 1 ? std::sqrt( M2[i] / ( count[i] - 1 ) ) : 0.0;
+        return deviation;
+    }
 
     // Mutators
     void setSamplingSize( size_t size ) { M_size = size; };
 
     /**
-     * @brief Set the Sobol indice
+     * @brief Add a replicate of a Sobol indice
+     *
+     * The indice is the running mean of its replicates, whose variance is
+     * accumulated by the Welford update, and its interval is their range.
      *
      * @param indice value obtained with the algorithm
      * @param i index computed
@@ -63,16 +86,28 @@ public:
     void setIndice( OT::Scalar indice, size_t i, int order )
     {
         if (order == 1)
-        {
-            M_firstOrder[i] += indice;
-            if (indice < M_firstOrderMin[i]) M_firstOrderMin[i] = indice;
-            if (indice > M_firstOrderMax[i]) M_firstOrderMax[i] = indice;
-        }
+            accumulate( indice, 1, 0, indice, indice, M_firstOrder[i], M_firstOrderM2[i], M_firstOrderCount[i], M_firstOrderMin[i], M_firstOrderMax[i] );
         else
+            accumulate( indice, 1, 0, indice, indice, M_totalOrder[i], M_totalOrderM2[i], M_totalOrderCount[i], M_totalOrderMin[i], M_totalOrderMax[i] );
+    }
+
+    /**
+     * @brief Merge the replicates added by setIndice to other results
+     *
+     * The merged means, variances and ranges are the ones of the union of the
+     * replicates, so that replicates computed separately (by threads or ranks)
+     * can be reduced in any grouping.
+     *
+     * @param other results of the same dimension
+     */
+    void merge( Results const& other )
+    {
+        for (size_t i = 0; i < M_dim; ++i)
         {
-            M_totalOrder[i] += indice;
-            if (indice < M_totalOrderMin[i]) M_totalOrderMin[i] = indice;
-            if (indice > M_totalOrderMax[i]) M_totalOrderMax[i] = indice;
+            accumulate( other.M_firstOrder[i], other.M_firstOrderCount[i], other.M_firstOrderM2[i], other.M_firstOrderMin[i], other.M_firstOrderMax[i],
+                        M_firstOrder[i], M_firstOrderM2[i], M_firstOrderCount[i], M_firstOrderMin[i], M_firstOrderMax[i] );
+            accumulate( other.M_totalOrder[i], other.M_totalOrderCount[i], other.M_totalOrderM2[i], other.M_totalOrderMin[i], other.M_totalOrderMax[i],
+                        M_totalOrder[i], M_totalOrderM2[i], M_totalOrderCount[i], M_totalOrderMin[i], M_totalOrderMax[i] );
         }
     }
 
@@ -88,6 +123,11 @@ public:
         std::fill(M_totalOrderMin.begin(), M_totalOrderMin.end(), 1.0);
         std::fill(M_firstOrderMax.begin(), M_firstOrderMax.end(), 0.0);
         std::fill(M_totalOrderMax.begin(), M_totalOrderMax.end(), 0.0);
+        std::fill(M_firstOrderM2.begin(), M_firstOrderM2.end(), 0.0);
+        std::fill(M_totalOrderM2.begin(), M_totalOrderM2.end(), 0.0);
+        std::fill(M_firstOrderCount.begin(), M_firstOrderCount.end(), 0);
+        std::fill(M_totalOrderCount.begin(), M_totalOrderCount.end(), 0);
+        M_secondOrder.clear();
     }
 
     /**
@@ -135,17 +175,56 @@ public:
     }
 
     /**
-     * @brief Normalize indices by the number of execution runned
+     * @brief Set the second order indices
      *
-     * @param nrun number of execution runned
+     * @param S matrix of size dim x dim, S(i, j) being the interaction of the variables i and j
      */
-    void normalize( int nrun )
+    void setSecondOrderIndices( OT::Matrix const& S )
     {
-        for (size_t i = 0; i < M_dim; ++i)
+        if ( S.getNbRows() != M_dim || S.getNbColumns() != M_dim )
         {
-            M_firstOrder[i] /= nrun;
-            M_totalOrder[i] /= nrun;
+            std::cout << "Error: dimension of the matrix is not the same as the dimension of the problem" << std::endl;
+            return;
         }
+        M_secondOrder.assign( M_dim * M_dim, 0.0 );
+        for (size_t i = 0; i < M_dim; ++i)
+            for (size_t j = 0; j < M_dim; ++j)
+                M_secondOrder[i*M_dim + j] = ( i == j ) ? 0.0 : S(i, j);
+    }
+
+    /**
+     * @brief Write the indices and intervals on a single line, to be read back by load
+     *
+     * @param out output stream
+     */
+    void save( std::ostream& out ) const
+    {
+        out.precision( 17 );
+        out << M_size;
+        for ( auto const* v : { &M_firstOrder, &M_totalOrder, &M_firstOrderMin, &M_firstOrderMax, &M_totalOrderMin, &M_totalOrderMax,
+                                &M_firstOrderM2, &M_totalOrderM2 } )
+            for (size_t i = 0; i < M_dim; ++i)
+                out << " " << (*v)[i];
+        for ( auto const* v : { &M_firstOrderCount, &M_totalOrderCount } )
+            for (size_t i = 0; i < M_dim; ++i)
+                out << " " << (*v)[i];
+    }
+
+    /**
+     * @brief Read the indices and intervals written by save
+     *
+     * @param in input stream
+     */
+    void load( std::istream& in )
+    {
+        in >> M_size;
+        for ( auto* v : { &M_firstOrder, &M_totalOrder, &M_firstOrderMin, &M_firstOrderMax, &M_totalOrderMin, &M_totalOrderMax,
+                          &M_firstOrderM2, &M_totalOrderM2 } )
+            for (size_t i = 0; i < M_dim; ++i)
+                in >> (*v)[i];
+        for ( auto* v : { &M_firstOrderCount, &M_totalOrderCount } )
+            for (size_t i = 0; i < M_dim; ++i)
+                in >> (*v)[i];
     }
 
     /**
@@ -162,6 +241,17 @@ public:
         Feel::cout << "TotalOrderIntervals" << std::endl;
         for (size_t i=0; i < M_dim; ++i)
             Feel::cout << "\t[" << M_totalOrderMin[i] << ", " << M_totalOrderMax[i] << "]" << std::endl;
+        if ( hasSecondOrder() )
+        {
+            Feel::cout << "Second order indices" << std::endl;
+            for (size_t i=0; i < M_dim; ++i)
+            {
+                Feel::cout << "\t" << M_names[i] << ":";
+                for (size_t j=0; j < M_dim; ++j)
+                    Feel::cout << " " << M_secondOrder[i*M_dim + j];
+                Feel::cout << std::endl;
+            }
+        }
     }
 
     /**
@@ -227,12 +317,51 @@ public:
             }
         }
         file << "]" << std::endl;
-        file << "\t}" << std::endl;
+        file << "\t}";
+        if ( hasSecondOrder() )
+        {
+            file << "," << std::endl;
+            file << "\t\"SecondOrder\":\n\t{" << std::endl;
+            file << "\t\t\"values\": [";
+            for (size_t i = 0; i < M_dim; ++i)
+            {
+                file << "[";
+                for (size_t j = 0; j < M_dim; ++j)
+                {
+                    file << M_secondOrder[i*M_dim + j];
+                    if (j != M_dim - 1)
+                        file << ", ";
+                }
+                file << "]";
+                if (i != M_dim - 1)
+                    file << ", ";
+            }
+            file << "]" << std::endl;
+            file << "\t}";
+        }
+        file << std::endl;
         file << "}" << std::endl;
         file.close();
     }
 
 private:
+    /**
+     * @brief Merge the statistics (mean, M2, count, min, max) of a group of replicates into another one
+     */
+    static void accumulate( OT::Scalar mean, size_t count, OT::Scalar M2, OT::Scalar min, OT::Scalar max,
+                            OT::Scalar& mean_acc, OT::Scalar& M2_acc, size_t& count_acc, OT::Scalar& min_acc, OT::Scalar& max_acc )
+    {
+        if ( count == 0 )
+            return;
+        size_t n = count_acc + count;
+        OT::Scalar delta = mean - mean_acc;
+        mean_acc += delta * count / n;
+        M2_acc += M2 + delta * delta * count_acc * count / n;
+        count_acc = n;
+        min_acc = std::min( min_acc, min );
+        max_acc = std::max( max_acc, max );
+    }
+
     size_t M_dim;
     std::vector<std::string> M_names;
     std::string M_algo;
@@ -240,6 +369,9 @@ private:
     std::vector<OT::Scalar> M_firstOrder, M_totalOrder;
     std::vector<OT::Scalar> M_firstOrderMin, M_firstOrderMax;
     std::vector<OT::Scalar> M_totalOrderMin, M_totalOrderMax;
+    std::vector<OT::Scalar> M_firstOrderM2, M_totalOrderM2;   // sums of the squared deviations of the replicates
+    std::vector<size_t> M_firstOrderCount, M_totalOrderCount; // numbers of replicates
+    std::vector<OT::Scalar> M_secondOrder;    // dim x dim, row-major, empty if not computed
 };
 
 
@@ -31,8 +31,12 @@
 #include <feel/feelmor/crbmodeldb.hpp>
 
 #include <iostream>
+#include <chrono>
 #include <ctime>
 #include <execution>
+#include <numeric>
+#include <optional>
+#include <sstream>
 
 #if defined(FEELPP_HAS_MONGOCXX )
 #include <bsoncxx/json.hpp>
@@ -48,14 +52,31 @@
 #include "../tqdm/tqdm.h"
 #include "results.hpp"
 #include "FunctionalChaos.hpp"
+#include "ChaosDesignMatrix.hpp"
+#include "MetamodelExport.hpp"
+#include "Evaluator.hpp"
+#include "MarginalSpec.hpp"
+#include "Sampling.hpp"
+#include "Checkpoint.hpp"
+#include "MultiFidelity.hpp"
+#include "StreamingSobol.hpp"
+#include "StreamingChaos.hpp"
+#include "../common/BoundedQueue.hpp"
+#include "SurrogateMonteCarlo.hpp"
 
 typedef Feel::ParameterSpaceX::element_type element_t;
 typedef std::shared_ptr<Feel::CRBPluginAPI> plugin_ptr_t;
 typedef std::shared_ptr<Feel::ParameterSpaceX> parameter_space_ptr_t;
 
 
+/**
+ * @brief Load the plugin of the CRB database selected by the options
+ *
+ * @param dbRepository if not null, set to the repository of the loaded database
+ * @return std::shared_ptr<Feel::CRBPluginAPI>
+ */
 std::shared_ptr<Feel::CRBPluginAPI>
-loadPlugin()
+loadPlugin( std::string* dbRepository = nullptr )
 {
     using namespace Feel;
 
@@ -80,6 +101,12 @@ loadPlugin()
     }
     auto meta = crbmodelDB.loadDBMetaData( attribute, attribute_data );
     Feel::cout << "-- crbmodelDB::dbRepository()=" << crbmodelDB.dbRepository() << std::endl;
+    if ( dbRepository )
+    {
+        std::ostringstream repository;
+        repository << crbmodelDB.dbRepository();
+        *dbRepository = repository.str();
+    }
 
     return crbmodelDB.loadDBPlugin( meta, soption(_name="crbmodel.db.load" ) );
 }
@@ -113,96 +140,116 @@ OT::ComposedDistribution composedFromModel(parameter_space_ptr_t Dmu )
     std::vector<std::string> names = Dmu->parameterNames();
     Feel::cout << tc::cyan << "names = " << names << tc::reset << std::endl;
 
-    OT::Collection<OT::Distribution> marginals(Dmu->dimension());
+    std::vector<MarginalSpec> marginals;
 
     for ( uint16_type d=0; d<Dmu->dimension(); ++d)
     {
-        OT::Distribution dist;
         if (names[d] == "h_amb")
         {
             double s = 1; double mu = log(10) - 0.5*s*s;
-            dist = OT::TruncatedDistribution(OT::LogNormal(mu, s, 8), OT::Interval(8, 100));
+            marginals.push_back( MarginalSpec::truncatedLogNormal( names[d], mu, s, 8, 8, 100 ) );
         }
         else if (names[d] == "E")
         {
             double s = 0.7; double mu = log(40.) - 0.5*s*s;
-            dist = OT::TruncatedDistribution(OT::LogNormal(mu, s, 20), OT::Interval(20, 130));
+            marginals.push_back( MarginalSpec::truncatedLogNormal( names[d], mu, s, 20, 20, 130 ) );
         }
         else if (names[d] == "h_bl")
         {
             double s = 0.15; double mu = log(65) - 0.5*s*s;
-            dist = OT::TruncatedDistribution(OT::LogNormal(mu, s, 0), OT::Interval(50, 120));
+            marginals.push_back( MarginalSpec::truncatedLogNormal( names[d], mu, s, 0, 50, 120 ) );
         }
         else
-            dist = OT::Uniform( mumin(d), mumax(d) );
-        dist.setDescription({names[d]});
-        marginals[d] = dist;
-        Feel::cout << tc::blue << "Distribution " << d << " (" << names[d] << ") = " << dist << tc::reset << std::endl;
+            marginals.push_back( MarginalSpec::uniform( names[d], mumin(d), mumax(d) ) );
+        Feel::cout << tc::blue << "Distribution " << d << " (" << names[d] << ") = " << marginals.back().distribution() << tc::reset << std::endl;
     }
 
-    return OT::ComposedDistribution( marginals );
+    return composedDistribution( marginals );
 }
 
 /**
- * @brief Generate the output sample from a given input sample
+ * @brief Compute the outputs of the rows of a design which are not in output yet
+ *
+ * With a checkpoint, the outputs are computed by blocks of checkpoint.interval
+ * rows, each block being saved.
  *
- * @param input Sample of input parameters
- * @param plugin loaded plugin
- * @param time_crb collection of timers
- * @param online_tol online tolerance
- * @param rbDim size of the reduced basis
- * @return OT::Sample 
+ * @param evaluator evaluator of the outputs
+ * @param input input design
+ * @param output outputs of the first rows of the design, extended to the size of the design
+ * @param checkpoint checkpoint of the run, or nullptr
+ * @param name name of the output sample in the checkpoint
  */
-OT::Sample output(OT::Sample const& input, plugin_ptr_t const& plugin, Eigen::VectorXd &time_crb, double online_tol, int rbDim)
+void extendOutput( Evaluator& evaluator, OT::Sample const& input, OT::Sample& output, std::shared_ptr<Checkpoint> const& checkpoint, std::string const& name )
 {
     size_t n = input.getSize();
-    OT::Sample output(n, 1);
+    while ( output.getSize() < n )
     {
-        parameter_space_ptr_t Dmu = plugin->parameterSpace();
-        std::vector<std::string> names = Dmu->parameterNames();
-        Feel::cout << "Start to compute outputs, sampling of size " << n << std::endl;
-#if 0
-        auto exec_rb = [&input, &Dmu, &time_crb, rbDim, &plugin, online_tol, &output] (int i) {
-            OT::Point X = input[i];
-            element_t mu = Dmu->element();
-            for (size_t j = 0; j < Dmu->dimension(); ++j)
-            {
-                mu.setParameter(j, X[j]);
-            }
-            Feel::CRBResults crbResult = plugin->run( mu, time_crb, online_tol, rbDim, false );
-            output[i] = OT::Point({boost::get<0>( crbResult )[0]});
-        };
-
-        std::vector<int> r(n);
-        std::for_each( std::execution::par, r.begin(), r.end(), exec_rb );
-#else
-        for (size_t i: tqdm::range(n))          // std::for_each
+        size_t begin = output.getSize();
+        size_t end = checkpoint ? std::min( n, begin + checkpoint->interval() ) : n;
+        output.add( evaluator.output( OT::Sample( input, begin, end ) ) );
+        if ( checkpoint )
         {
-            element_t mu = Dmu->element();
-            OT::Point X = input[i];
-            for (size_t j = 0; j < Dmu->dimension(); ++j)
-            {
-                mu.setParameter(j, X[j]);
-            }
-            Feel::CRBResults crbResult = plugin->run( mu, time_crb, online_tol, rbDim, false );
-            output[i] = OT::Point({boost::get<0>( crbResult )[0]});
+            checkpoint->saveSample( name, output );
+            checkpoint->commit();
         }
-#endif
-        Feel::cout << "output computed" << std::endl;
     }
-    return output;
 }
 
+/**
+ * @brief Compute the outputs of a design, by blocks saved in the checkpoint
+ *
+ * When the run is resumed, the outputs saved in the checkpoint are reused and
+ * only the remaining ones are computed.
+ *
+ * @param evaluator evaluator of the outputs
+ * @param input input design
+ * @param checkpoint checkpoint of the run, or nullptr
+ * @param name name of the output sample in the checkpoint
+ * @return OT::Sample
+ */
+OT::Sample outputWithCheckpoint( Evaluator& evaluator, OT::Sample const& input, std::shared_ptr<Checkpoint> const& checkpoint, std::string const& name )
+{
+    if ( !checkpoint )
+        return evaluator.output( input );
+
+    OT::Sample output = checkpoint->has( name + ".rows" ) ? checkpoint->loadSample( name ) : OT::Sample(0, 1);
+    if ( output.getSize() > 0 )
+        Feel::cout << "Resume with " << output.getSize() << " output(s) over " << input.getSize() << " from the checkpoint" << std::endl;
+    extendOutput( evaluator, input, output, checkpoint, name );
+    return output;
+}
 
+/**
+ * @brief Confidence interval of the mean of independent replicates of the indices, from the Student distribution
+ *
+ * @param replicates indices computed by each replicate, one replicate per row
+ * @param level confidence level
+ * @return OT::Interval
+ */
+OT::Interval replicatesInterval( OT::Sample const& replicates, double level = 0.95 )
+{
+    size_t n = replicates.getSize();
+    OT::Point mean = replicates.computeMean();
+    OT::Point sd = replicates.computeStandardDeviation();
+    double t = OT::Student( n - 1 ).computeQuantile( 0.5 + level / 2 )[0];
+    OT::Point lower( mean ), upper( mean );
+    for (size_t i = 0; i < mean.getDimension(); ++i)
+    {
+        lower[i] -= t * sd[i] / std::sqrt( n );
+        upper[i] += t * sd[i] / std::sqrt( n );
+    }
+    return OT::Interval( lower, upper );
+}
 
 /**
  * @brief Compute sobol indices
  *
- * @param plugin std::vector containing the plugin from load_plugin
+ * @param evaluator evaluator of the outputs, holding the plugins loaded with loadPlugin
  * @param sampling_size size of the input sample used for computation of sobol indices
  * @param computeSecondOrder boolean to compute second order sobol indices
+ * @param checkpoint checkpoint where the state of the run is saved, nullptr to disable
  */
-void runSensitivityAnalysis( std::vector<plugin_ptr_t> plugin, size_t sampling_size, bool computeSecondOrder=true )
+void runSensitivityAnalysis( Evaluator& evaluator, size_t sampling_size, bool computeSecondOrder=true, std::shared_ptr<Checkpoint> checkpoint=nullptr )
 {
     using namespace Feel;
 
@@ -210,11 +257,7 @@ void runSensitivityAnalysis( std::vector<plugin_ptr_t> plugin, size_t sampling_s
 
     bool loadFiniteElementDatabase = boption(_name="crb.load-elements-database");
 
-    Eigen::VectorXd/*typename crb_type::vectorN_type*/ time_crb;
-    double online_tol = 1e-2;               //Feel::doption(Feel::_name="crb.online-tolerance");
-    int rbDim = ioption(_name="rb-dim");
-    bool print_rb_matrix = false;           //boption(_name="crb.print-rb-matrix");
-    parameter_space_ptr_t muspace = plugin[0]->parameterSpace();
+    parameter_space_ptr_t muspace = evaluator.parameterSpace();
 
     OT::ComposedDistribution composed_distribution = composedFromModel( muspace );
     std::vector<std::string> tableRowHeader = muspace->parameterNames();
@@ -222,41 +265,309 @@ void runSensitivityAnalysis( std::vector<plugin_ptr_t> plugin, size_t sampling_s
 
     double adapt_tol = doption(_name="adapt.tol");
 
-    // Compute Sobol indices using Saltelli method
-    if ( !boption("algo.poly") )
+    // Compute Sobol indices using Saltelli method, with a low fidelity model as control variate
+    if ( boption(_name="algo.multi-fidelity") )
+    {
+        int rbDimLow = ioption(_name="mf.rb-dim-low");
+        size_t pilot_size = std::min<size_t>( ioption(_name="mf.pilot-size"), sampling_size );
+        Feel::cout << tc::bold << tc::red << "Run multi-fidelity Saltelli : " << sampling_size << " high fidelity samples, low fidelity with rb-dim "
+            << rbDimLow << tc::reset << std::endl;
+        Results res( dim, tableRowHeader, "Saltelli-multi-fidelity", sampling_size );
+        MultiFidelitySobol mf( dim );
+
+        // pilot run, evaluated with both fidelities, to choose the number of low fidelity samples;
+        // the costs are measured on the online code itself, the outputs of the pilot may come from the cache
+        std::string sampling_type = soption(_name="sampling.type");
+        OT::Sample design = saltelliDesign( composed_distribution, pilot_size, sampling_type );
+        OT::Sample y_hi = evaluator.output( design );
+        OT::Sample y_lo = evaluator.output( design, rbDimLow );
+        size_t cost_size = std::max( ioption(_name="mf.cost-size"), 1 );
+        double cost_hi = evaluator.onlineCost( design, evaluator.rbDim(), cost_size );
+        double cost_lo = evaluator.onlineCost( design, rbDimLow, cost_size );
+        mf.addPaired( y_hi, y_lo, pilot_size );
+        double rho = MultiFidelitySobol::correlation( y_hi, y_lo );
+        double ratio = MultiFidelitySobol::sampleRatio( cost_hi, cost_lo, rho, doption(_name="mf.max-ratio") );
+        size_t low_size = std::ceil( ratio * sampling_size );
+        Feel::cout << "Pilot of size " << pilot_size << ": cost high " << cost_hi << "s, cost low " << cost_lo << "s, correlation " << rho
+            << " -> " << low_size << " low fidelity samples" << std::endl;
+
+        if ( sampling_size > pilot_size )
+        {
+            size_t n = sampling_size - pilot_size;
+            design = saltelliDesign( composed_distribution, n, sampling_type );
+            mf.addPaired( evaluator.output( design ), evaluator.output( design, rbDimLow ), n );
+        }
+        if ( low_size > sampling_size )
+        {
+            size_t n = low_size - sampling_size;
+            design = saltelliDesign( composed_distribution, n, sampling_type );
+            mf.addLow( evaluator.output( design, rbDimLow ), n );
+        }
+
+        mf.run();
+        res.setIndices( mf.firstOrder(), 1 );
+        res.setIndices( mf.totalOrder(), 2 );
+        res.setInterval( mf.interval( 1 ), 1 );
+        res.setInterval( mf.interval( 2 ), 2 );
+
+        res.print();
+        res.exportValues( "sensitivity-multi-fidelity.json" );
+    }
+
+    // Compute Sobol indices in one pass, the pick-freeze design being generated and evaluated by blocks
+    else if ( boption(_name="algo.streaming") )
+    {
+        std::string estimator = soption(_name="streaming.estimator");
+        std::string sampling_type = soption(_name="sampling.type");
+        size_t block_size = std::max( ioption(_name="streaming.block-size"), 1 );
+        Feel::cout << tc::bold << tc::red << "Run streaming " << estimator << " : " << sampling_size << " base samples by blocks of "
+            << block_size << tc::reset << std::endl;
+        Results res( dim, tableRowHeader, "streaming-" + estimator, sampling_size );
+        StreamingSobol sobol( dim );
+        Sampler sampler( doubledDistribution( composed_distribution ), sampling_type );
+
+        size_t saved = 0;
+        if ( checkpoint && checkpoint->resumed() )
+        {
+            checkpoint->check( "algo", "streaming" );
+            checkpoint->check( "sampling.type", sampling_type );
+            sobol.setState( checkpoint->getSample( "streaming-state" )[0] );
+            sampler.restore( sobol.size(), checkpoint->getSample( "streaming-shift" )[0] );
+            checkpoint->restoreRandomState();
+            saved = sobol.size();
+            Feel::cout << "Resume with " << saved << " base samples from the checkpoint" << std::endl;
+        }
+        else if ( checkpoint )
+        {
+            checkpoint->set( "algo", "streaming" );
+            checkpoint->set( "sampling.type", sampling_type );
+        }
+
+        // the shift and the random state are the ones of the sampler once the blocks folded so far are generated
+        auto save = [&]( OT::Point const& sampler_shift, OT::RandomGeneratorState const& rng ) {
+            if ( !checkpoint || ( sobol.size() - saved < checkpoint->interval() && sobol.size() < sampling_size ) )
+                return;
+            OT::Sample state( 1, sobol.state().getDimension() ), shift( 1, 2*dim );
+            state[0] = sobol.state();
+            if ( sampler_shift.getDimension() == 2*dim )
+                shift[0] = sampler_shift;
+            checkpoint->setSample( "streaming-state", state );
+            checkpoint->setSample( "streaming-shift", shift );
+            checkpoint->saveRandomState( rng );
+            checkpoint->commit();
+            saved = sobol.size();
+        };
+
+        if ( boption(_name="algo.pipeline") )
+        {
+            // the blocks are generated, evaluated and folded by three concurrent stages,
+            // the evaluation running on this thread
+            struct Block
+            {
+                size_t size = 0;
+                OT::Sample design, output;
+                OT::Point shift;
+                OT::RandomGeneratorState rng;
+            };
+            size_t planned = sobol.size();
+            tic();
+            runPipeline<Block>( std::max( ioption(_name="pipeline.depth"), 1 ),
+                [&]( Block& block ) {
+                    if ( planned >= sampling_size )
+                        return false;
+                    block.size = std::min( block_size, sampling_size - planned );
+                    planned += block.size;
+                    block.design = pickFreezeDesign( sampler.generate( block.size ) );
+                    block.design.setDescription( composed_distribution.getDescription() );
+                    block.shift = sampler.shift();
+                    block.rng = OT::RandomGenerator::GetState();
+                    return true;
+                },
+                [&]( Block& block ) { block.output = evaluator.output( block.design ); },
+                [&]( Block& block ) {
+                    sobol.add( block.output.data(), block.size );
+                    save( block.shift, block.rng );
+                } );
+            toc("pipeline");
+        }
+        else while ( sobol.size() < sampling_size )
+        {
+            size_t m = std::min( block_size, sampling_size - sobol.size() );
+            OT::Sample design = pickFreezeDesign( sampler.generate( m ) );
+            design.setDescription( composed_distribution.getDescription() );
+            OT::Sample y = evaluator.output( design );
+            sobol.add( y.data(), m );
+            save( sampler.shift(), OT::RandomGenerator::GetState() );
+        }
+
+        res.setIndices( sobol.firstOrder( estimator ), 1 );
+        res.setIndices( sobol.totalOrder( estimator ), 2 );
+        res.setInterval( sobol.interval( estimator, 1 ), 1 );
+        res.setInterval( sobol.interval( estimator, 2 ), 2 );
+
+        res.print();
+        res.exportValues( "sensitivity-streaming.json" );
+    }
+
+    else if ( !boption("algo.poly") )
     {
+        // each replicate uses its own randomization of the design, the intervals
+        // then come from the spread of the replicates instead of the asymptotic distribution
+        std::string sampling_type = soption(_name="sampling.type");
+        size_t replicates = std::max( ioption(_name="sampling.replicates"), 1 );
+        // with a tolerance, the designs are extended by batches until the intervals are narrow enough
+        double tol = doption(_name="convergence.tol");
+        size_t max_size = tol > 0 ? std::max<size_t>( ioption(_name="convergence.max-size"), sampling_size ) : sampling_size;
+        size_t batch_size = ioption(_name="convergence.batch-size") > 0 ? ioption(_name="convergence.batch-size") : sampling_size;
+        size_t blocks = computeSecondOrder ? 2*dim + 2 : dim + 2;
         Results res( dim, tableRowHeader, "Saltelli", sampling_size );
-        OT::SobolIndicesExperiment sobol(composed_distribution, sampling_size, computeSecondOrder);
-        tic();
-        OT::Sample inputDesign = sobol.generate();
-        toc("input design");
-        Feel::cout << "inputDesign generated" << std::endl;
-        tic();
-        OT::Sample outputDesign = output(inputDesign, plugin[0], time_crb, online_tol, rbDim);
-        toc("output design");
-
-        OT::SaltelliSensitivityAlgorithm sensitivity(inputDesign, outputDesign, sampling_size);
-        sensitivity.setUseAsymptoticDistribution( true );
-
-        OT::Point firstOrder = sensitivity.getFirstOrderIndices();
-        OT::Interval intervals = sensitivity.getFirstOrderIndicesInterval();
-        OT::Point totalOrder = sensitivity.getTotalOrderIndices();
-        OT::Interval totalIntervals = sensitivity.getTotalOrderIndicesInterval();
-
-        for (size_t i = 0; i < dim; ++i)
+
+        // designs of each replicate, concatenation of the designs of its batches
+        std::vector<Sampler> samplers;
+        std::vector<OT::Sample> inputDesigns, outputDesigns;
+        std::vector<std::vector<size_t>> batches( replicates );
+        for (size_t r = 0; r < replicates; ++r)
         {
-            OT::Scalar o1 = firstOrder[i];
-            OT::Scalar ot = totalOrder[i];
-            if ( o1 > ot )
+            samplers.push_back( Sampler( doubledDistribution( composed_distribution ), sampling_type ) );
+            inputDesigns.push_back( OT::Sample(0, dim) );
+            outputDesigns.push_back( OT::Sample(0, 1) );
+        }
+        auto batchesSize = []( std::vector<size_t> const& b ) { return std::accumulate( b.begin(), b.end(), size_t(0) ); };
+
+        if ( checkpoint && checkpoint->resumed() )
+        {
+            checkpoint->check( "algo", "saltelli" );
+            checkpoint->check( "sampling-size", sampling_size );
+            checkpoint->check( "sampling.type", sampling_type );
+            checkpoint->check( "sampling.replicates", replicates );
+            checkpoint->check( "second-order", computeSecondOrder );
+            for (size_t r = 0; r < replicates; ++r)
             {
-                Feel::cout << tc::red << "Warning: o1 > ot" << tc::reset << std::endl;
-                throw std::logic_error("Issue in computing sobol indices");
+                std::string suffix = "-" + std::to_string(r);
+                if ( !checkpoint->has( "saltelli-input" + suffix + ".rows" ) )
+                    continue;
+                inputDesigns[r] = checkpoint->loadSample( "saltelli-input" + suffix );
+                if ( checkpoint->has( "saltelli-output" + suffix + ".rows" ) )
+                    outputDesigns[r] = checkpoint->loadSample( "saltelli-output" + suffix );
+                std::istringstream in( checkpoint->value( "saltelli-batches" + suffix ) );
+                for (size_t m; in >> m; )
+                    batches[r].push_back( m );
+                samplers[r].restore( batchesSize( batches[r] ), checkpoint->getSample( "saltelli-shift" + suffix )[0] );
+                Feel::cout << "inputDesign " << r << " loaded from the checkpoint" << std::endl;
             }
+            checkpoint->restoreRandomState();
+        }
+        else if ( checkpoint )
+        {
+            checkpoint->set( "algo", "saltelli" );
+            checkpoint->set( "sampling-size", sampling_size );
+            checkpoint->set( "sampling.type", sampling_type );
+            checkpoint->set( "sampling.replicates", replicates );
+            checkpoint->set( "second-order", computeSecondOrder );
+        }
+
+        size_t n = sampling_size;
+        for (size_t r = 0; r < replicates; ++r)
+            n = std::max( n, batchesSize( batches[r] ) );
+        while ( true )
+        {
+            OT::Sample firstOrders( replicates, dim ), totalOrders( replicates, dim );
+            OT::Matrix secondOrder( dim, dim );
+            for (size_t r = 0; r < replicates; ++r)
+            {
+                std::string suffix = "-" + std::to_string(r);
+                size_t done = batchesSize( batches[r] );
+                if ( done < n )
+                {
+                    size_t m = n - done;
+                    tic();
+                    OT::Sample design;
+                    if ( sampling_type == "random" )
+                        design = OT::SobolIndicesExperiment( composed_distribution, m, computeSecondOrder ).generate();
+                    else
+                        design = pickFreezeDesign( samplers[r].generate( m ), computeSecondOrder );
+                    inputDesigns[r].add( design );
+                    batches[r].push_back( m );
+                    toc("input design");
+                    Feel::cout << "inputDesign generated (" << sampling_type << " sampling, " << m << " base samples)" << std::endl;
+                    if ( checkpoint )
+                    {
+                        std::ostringstream sizes;
+                        for (size_t b : batches[r])
+                            sizes << b << " ";
+                        OT::Sample shift( 1, 2*dim );
+                        if ( samplers[r].shift().getDimension() == 2*dim )
+                            shift[0] = samplers[r].shift();
+                        checkpoint->saveSample( "saltelli-input" + suffix, inputDesigns[r] );
+                        checkpoint->set( "saltelli-batches" + suffix, sizes.str() );
+                        checkpoint->setSample( "saltelli-shift" + suffix, shift );
+                        checkpoint->saveRandomState();
+                        checkpoint->commit();
+                    }
+                }
+                tic();
+                extendOutput( evaluator, inputDesigns[r], outputDesigns[r], checkpoint, "saltelli-output" + suffix );
+                toc("output design");
+
+                OT::Sample inputDesign = mergePickFreezeDesigns( inputDesigns[r], batches[r], blocks );
+                OT::Sample outputDesign = mergePickFreezeDesigns( outputDesigns[r], batches[r], blocks );
+                inputDesign.setDescription( composed_distribution.getDescription() );
+                OT::SaltelliSensitivityAlgorithm sensitivity(inputDesign, outputDesign, n);
+                sensitivity.setUseAsymptoticDistribution( true );
+
+                OT::Point firstOrder = sensitivity.getFirstOrderIndices();
+                OT::Point totalOrder = sensitivity.getTotalOrderIndices();
+
+                for (size_t i = 0; i < dim; ++i)
+                {
+                    OT::Scalar o1 = firstOrder[i];
+                    OT::Scalar ot = totalOrder[i];
+                    if ( o1 > ot )
+                    {
+                        Feel::cout << tc::red << "Warning: o1 > ot" << tc::reset << std::endl;
+                        throw std::logic_error("Issue in computing sobol indices");
+                    }
+                }
+                firstOrders[r] = firstOrder;
+                totalOrders[r] = totalOrder;
+                if ( computeSecondOrder )
+                {
+                    OT::SymmetricMatrix S2 = sensitivity.getSecondOrderIndices();
+                    for (size_t i = 0; i < dim; ++i)
+                        for (size_t j = 0; j < dim; ++j)
+                            secondOrder(i, j) += S2(i, j) / replicates;
+                }
+                if ( replicates == 1 )
+                {
+                    res.setInterval( sensitivity.getFirstOrderIndicesInterval(), 1);
+                    res.setInterval( sensitivity.getTotalOrderIndicesInterval(), 2);
+                }
+            }
+
+            res.setSamplingSize( n );
+            res.setIndices( firstOrders.computeMean(), 1);
+            res.setIndices( totalOrders.computeMean(), 2);
+            if ( computeSecondOrder )
+                res.setSecondOrderIndices( secondOrder );
+            if ( replicates > 1 )
+            {
+                res.setInterval( replicatesInterval( firstOrders ), 1 );
+                res.setInterval( replicatesInterval( totalOrders ), 2 );
+            }
+
+            if ( tol <= 0 )
+                break;
+            double width = res.maxIntervalWidth();
+            Feel::cout << tc::cyan << "Saltelli with " << n << " base samples: maximal width of the intervals " << width << tc::reset << std::endl;
+            if ( width < tol )
+                break;
+            if ( n >= max_size )
+            {
+                Feel::cout << tc::red << "Warning: convergence.max-size reached before convergence.tol" << tc::reset << std::endl;
+                break;
+            }
+            n = std::min( n + batch_size, max_size );
         }
-        res.setIndices( firstOrder, 1);
-        res.setIndices( totalOrder, 2);
-        res.setInterval( intervals, 1);
-        res.setInterval( totalIntervals, 2);
 
         res.print();
         res.exportValues( "sensitivity-saltelli.json" );
@@ -270,38 +581,203 @@ void runSensitivityAnalysis( std::vector<plugin_ptr_t> plugin, size_t sampling_s
         Feel::cout << tc::bold << tc::red << "Run polynomial chaos and bootstrap : sampling of size " << sampling_size
             << " (bootstrap size " << bootstrap_size << ")" << tc::reset << std::endl;
 
-        OT::Collection<OT::Distribution> marginals(dim);
-        for ( size_t d=0; d<dim; ++d )
-            marginals[d] = composed_distribution.getMarginal(d);
-        auto basis = OT::OrthogonalProductPolynomialFactory( marginals );
-        OT::UnsignedInteger total_degree = 3;
+        auto basis = chaosBasis( composed_distribution, doption(_name="algo.q-norm") );
+        OT::UnsignedInteger total_degree = ioption(_name="algo.total-degree");
 
         Results res( dim, tableRowHeader, "polynomial-chaos-bootstrap", sampling_size );
+        // with a tolerance, the sample is extended by batches until the intervals are narrow enough
+        double tol = doption(_name="convergence.tol");
+        size_t max_size = tol > 0 ? std::max<size_t>( ioption(_name="convergence.max-size"), sampling_size ) : sampling_size;
+        size_t batch_size = ioption(_name="convergence.batch-size") > 0 ? ioption(_name="convergence.batch-size") : sampling_size;
+
+        Sampler sampler( composed_distribution, soption(_name="sampling.type") );
+        OT::Sample input_sample( 0, dim ), output_sample( 0, 1 );
+        // without algo.bootstrap-seed, the selections are seeded by sampling.seed, or drawn from the random generator
+        std::uint64_t bootstrap_seed = ioption(_name="algo.bootstrap-seed") >= 0 ? ioption(_name="algo.bootstrap-seed")
+            : ioption(_name="sampling.seed") > 0 ? ioption(_name="sampling.seed") : OT::RandomGenerator::IntegerGenerate( 1u << 31 );
+        if ( checkpoint && checkpoint->resumed() )
+        {
+            checkpoint->check( "algo", "bootstrap" );
+            checkpoint->check( "sampling-size", sampling_size );
+            bootstrap_seed = checkpoint->get<std::uint64_t>( "bootstrap-seed", bootstrap_seed );
+            input_sample = checkpoint->loadSample( "bootstrap-input" );
+            if ( checkpoint->has( "bootstrap-output.rows" ) )
+                output_sample = checkpoint->loadSample( "bootstrap-output" );
+            sampler.restore( input_sample.getSize(), checkpoint->getSample( "bootstrap-shift" )[0] );
+            checkpoint->restoreRandomState();
+        }
+        else if ( checkpoint )
+        {
+            checkpoint->set( "algo", "bootstrap" );
+            checkpoint->set( "sampling-size", sampling_size );
+            checkpoint->set( "bootstrap-seed", bootstrap_seed );
+        }
+        input_sample.setDescription( composed_distribution.getDescription() );
+
+        size_t n = std::max( sampling_size, input_sample.getSize() );
+        OT::Graph graph;
+        while ( true )
+        {
+            if ( input_sample.getSize() < n )
+            {
+                input_sample.add( sampler.generate( n - input_sample.getSize() ) );
+                if ( checkpoint )
+                {
+                    OT::Sample shift( 1, dim );
+                    if ( sampler.shift().getDimension() == dim )
+                        shift[0] = sampler.shift();
+                    checkpoint->saveSample( "bootstrap-input", input_sample );
+                    checkpoint->setSample( "bootstrap-shift", shift );
+                    checkpoint->saveRandomState();
+                    checkpoint->commit();
+                }
+            }
+            tic();
+            extendOutput( evaluator, input_sample, output_sample, checkpoint, "bootstrap-output" );
+            toc("output sample");
+
+            res.setSamplingSize( n );
+            size_t bootstrap_threads = threadCount( ioption(_name="algo.bootstrap-threads") );
+            if ( boption(_name="algo.adaptive-degree") )
+            {
+                tic();
+                ChaosDegree selected = selectChaosDegree( input_sample, output_sample, composed_distribution,
+                    ioption(_name="algo.max-degree"), doption(_name="algo.q-norm"), bootstrap_threads );
+                toc("selectChaosDegree");
+                basis = selected.basis;
+                total_degree = selected.degree;
+                Feel::cout << tc::green << "Selected total degree " << total_degree << " (leave-one-out error " << selected.error << ")" << tc::reset << std::endl;
+            }
+            bool refit = soption(_name="algo.bootstrap-engine") != "design-matrix";
+            if ( !refit )
+            {
+                // the basis is evaluated once, each replicate being a weighted least squares solve
+                tic();
+                ChaosDesignMatrix psi( input_sample, composed_distribution, basis, total_degree );
+                ChaosDesignMatrix::support_t support = boption(_name="algo.bootstrap-fixed-sparsity")
+                    ? psi.sparseSupport( input_sample, output_sample, basis, total_degree, composed_distribution )
+                    : psi.fullSupport();
+                if ( psi.determined( support.size() ) )
+                {
+                    auto [fo_sample, to_sample] = psi.bootstrap( output_sample, support, bootstrap_size, bootstrap_threads, bootstrap_seed );
+                    toc("design matrix bootstrap");
+                    Feel::cout << "Design matrix bootstrap with " << support.size() << " term(s) over " << psi.basisSize() << std::endl;
+                    graph = setAndDrawSobolIndices( res, input_sample.getDescription(), n, fo_sample, to_sample );
+                }
+                else
+                {
+                    Feel::cout << tc::red << "Warning: " << n << " sample(s) for " << support.size()
+                               << " term(s), the sparse chaos is refitted on each replicate" << tc::reset << std::endl;
+                    refit = true;
+                }
+            }
+            if ( refit )
+                graph = computeAndDrawSobolIndices( res, input_sample, output_sample, basis, total_degree, composed_distribution, bootstrap_size, 0.95,
+                    bootstrap_threads, bootstrap_seed );
 
-        OT::Sample input_sample = composed_distribution.getSample(sampling_size);
-        tic();
-        OT::Sample output_sample = output(input_sample, plugin[0], time_crb, online_tol, rbDim);
-        toc("output sample");
+            if ( tol <= 0 )
+                break;
+            double width = res.maxIntervalWidth();
+            Feel::cout << tc::cyan << "Bootstrap with a sample of size " << n << ": maximal width of the intervals " << width << tc::reset << std::endl;
+            if ( width < tol )
+                break;
+            if ( n >= max_size )
+            {
+                Feel::cout << tc::red << "Warning: convergence.max-size reached before convergence.tol" << tc::reset << std::endl;
+                break;
+            }
+            n = std::min( n + batch_size, max_size );
+        }
 
-        // Check the meta-model
-        if ( boption(_name="algo.check-meta-model"))
+        // Check, export and sample the meta-model
+        std::string metamodel_path = soption(_name="metamodel.export"), code_path = soption(_name="metamodel.export-code");
+        size_t mc_size = ioption(_name="metamodel.mc-size");
+        if ( boption(_name="algo.check-meta-model") || !metamodel_path.empty() || !code_path.empty() || mc_size > 0 )
         {
             Feel::cout << "Compute Sparse Least Squares Chaos" << std::endl;
             tic();
             OT::FunctionalChaosResult polynomialChaosResult =
                 computeSparseLeastSquaresChaos(input_sample, output_sample, basis, total_degree, composed_distribution);
             toc("computeSparseLeastSquaresChaos");
-            tic();
-            OT::Function metaModel = polynomialChaosResult.getMetaModel();
-            OT::UnsignedInteger n_valid = 1000;
-            OT::Sample X_test = composed_distribution.getSample(n_valid);
-            OT::Sample Y_test = output(X_test, plugin[0], time_crb, online_tol, rbDim);
-            checkMetaModel( X_test, Y_test, metaModel );
-            toc("checkMetaModel");
+
+            // the batch kernel needs an affine transformation of the inputs, otherwise the OpenTURNS metamodel is used
+            std::optional<ChaosMetamodel> metamodel;
+            if ( !metamodel_path.empty() || !code_path.empty() || mc_size > 0 || soption(_name="algo.validation") == "test" )
+            {
+                try
+                {
+                    metamodel = exportChaos( polynomialChaosResult, basis, composed_distribution );
+                }
+                catch ( std::runtime_error const& e )
+                {
+                    Feel::cout << tc::red << "Warning: " << e.what() << tc::reset << std::endl;
+                }
+            }
+            size_t metamodel_threads = threadCount( ioption(_name="metamodel.threads") );
+            if ( boption(_name="algo.check-meta-model") )
+            {
+                tic();
+                std::string validation = soption(_name="algo.validation");
+                if ( validation == "test" )
+                {
+                    // the test sample is the same from one run to the other, so that its outputs come from the cache
+                    OT::Sample X_test = reproducibleSample( composed_distribution, ioption(_name="algo.validation-size"), ioption(_name="algo.validation-seed") );
+                    OT::Sample Y_test = evaluator.output(X_test);
+                    if ( metamodel )
+                    {
+                        ChaosBatchKernel kernel( *metamodel );
+                        OT::Sample Y_pred( X_test.getSize(), 1 );
+                        parallelFor( X_test.getSize(), metamodel_threads, 16 * ChaosBatchKernel::block, [&]( size_t, size_t begin, size_t end ) {
+                            kernel.evaluateRows( X_test.data() + begin * dim, end - begin, Y_pred.data() + begin );
+                        } );
+                        checkMetaModel( Y_test, Y_pred );
+                    }
+                    else
+                        checkMetaModel( X_test, Y_test, polynomialChaosResult.getMetaModel() );
+                }
+                else
+                {
+                    // cross-validation on the training sample, from the hat matrix of the selected terms
+                    ChaosDesignMatrix psi( input_sample, composed_distribution, basis, total_degree );
+                    OT::Indices selected = polynomialChaosResult.getIndices();
+                    ChaosDesignMatrix::support_t support( selected.begin(), selected.end() );
+                    double error = ( validation == "kfold" )
+                        ? psi.kFoldError( output_sample, support, ioption(_name="algo.validation-folds") )
+                        : psi.leaveOneOutError( output_sample, support );
+                    Feel::cout << Feel::tc::green << "Check of the metamodel (" << validation << ") : Q2 = " << 1 - error << Feel::tc::reset << std::endl;
+                }
+                toc("checkMetaModel");
+            }
+            if ( ( !metamodel_path.empty() || !code_path.empty() ) && metamodel )
+            {
+                if ( !metamodel_path.empty() )
+                    metamodel->save( metamodel_path );
+                if ( !code_path.empty() )
+                    std::ofstream( code_path ) << metamodel->generateCode( "chaos_metamodel" );
+                Feel::cout << tc::green << "Metamodel of " << metamodel->size() << " term(s) exported" << tc::reset << std::endl;
+            }
+            if ( mc_size > 0 && metamodel )
+            {
+                // Monte Carlo on the metamodel, the design being generated and evaluated by blocks
+                std::string estimator = soption(_name="streaming.estimator");
+                ChaosBatchKernel kernel( *metamodel );
+                Feel::cout << tc::bold << tc::red << "Run surrogate Monte Carlo : " << mc_size << " base samples, "
+                    << kernel.instructionSet() << " kernel on " << metamodel_threads << " thread(s)" << tc::reset << std::endl;
+                tic();
+                StreamingSobol sobol( dim );
+                surrogateSobol( kernel, composed_distribution, mc_size,
+                    std::max( ioption(_name="metamodel.mc-block-size"), 1 ), metamodel_threads, sobol );
+                toc("surrogate Monte Carlo");
+                Results res_mc( dim, tableRowHeader, "surrogate-" + estimator, mc_size );
+                res_mc.setIndices( sobol.firstOrder( estimator ), 1 );
+                res_mc.setIndices( sobol.totalOrder( estimator ), 2 );
+                res_mc.setInterval( sobol.interval( estimator, 1 ), 1 );
+                res_mc.setInterval( sobol.interval( estimator, 2 ), 2 );
+                res_mc.print();
+                res_mc.exportValues( "sensitivity-surrogate.json" );
+            }
         }
         
-        res.print();
-        OT::Graph graph = computeAndDrawSobolIndices( res, input_sample, output_sample, basis, total_degree, composed_distribution, bootstrap_size=bootstrap_size);
         res.print();
         res.exportValues( "sensitivity-bootstrap.json" );
         graph.draw("sobol-indices.png");
@@ -318,43 +794,229 @@ void runSensitivityAnalysis( std::vector<plugin_ptr_t> plugin, size_t sampling_s
         OT::Sample indices(nrun, dim);
         Feel::cout << tc::green << "=====================================" << tc::reset << std::endl;
 
-        while ( !stop )
+        // the designs of each run are kept and extended from one iteration to the other
+        std::vector<Sampler> samplers;
+        std::vector<OT::Sample> input_samples, output_samples;
+        for (int r=0; r<nrun; ++r)
         {
-            res.reset();
-            OT::Scalar o1, ot;
+            samplers.push_back( Sampler( composed_distribution, soption(_name="sampling.type") ) );
+            input_samples.push_back( OT::Sample(0, dim) );
+            input_samples.back().setDescription( composed_distribution.getDescription() );
+            output_samples.push_back( OT::Sample(0, 1) );
+        }
+        size_t n_evaluations = 0;
+
+        // the state is saved after each run, the runs of the current iteration done being kept
+        int first_run = 0;
+        if ( checkpoint && checkpoint->resumed() )
+        {
+            checkpoint->check( "algo", "polynomial-chaos" );
+            checkpoint->check( "nrun", nrun );
+            checkpoint->check( "sampling.type", soption(_name="sampling.type") );
+            sampling_size = checkpoint->get<size_t>( "sampling-size" );
+            n_evaluations = checkpoint->get<size_t>( "n-evaluations" );
+            first_run = checkpoint->get<int>( "next-run" );
+            res.setSamplingSize( sampling_size );
+            std::istringstream results( checkpoint->value( "results" ) );
+            res.load( results );
+            indices = checkpoint->getSample( "indices" );
+            OT::Sample shifts = checkpoint->getSample( "shifts" );
+            for (int r=0; r<nrun; ++r)
+            {
+                input_samples[r] = checkpoint->loadSample( "input-" + std::to_string(r) );
+                input_samples[r].setDescription( composed_distribution.getDescription() );
+                output_samples[r] = checkpoint->loadSample( "output-" + std::to_string(r) );
+                samplers[r].restore( input_samples[r].getSize(), shifts[r] );
+            }
+            checkpoint->restoreRandomState();
+            Feel::cout << "Resume at run " << first_run+1 << " with sample of size " << sampling_size << std::endl;
+        }
+        else if ( checkpoint )
+        {
+            checkpoint->set( "algo", "polynomial-chaos" );
+            checkpoint->set( "nrun", nrun );
+            checkpoint->set( "sampling.type", soption(_name="sampling.type") );
+            OT::Sample shifts(nrun, dim);
             for (int r=0; r<nrun; ++r)
+                if ( samplers[r].shift().getDimension() == dim )
+                    shifts[r] = samplers[r].shift();
+            checkpoint->setSample( "shifts", shifts );
+        }
+
+        // the distribution, the basis and the strategies are built once and shared by all the fits of a run,
+        // each run owning its own copies so that the runs can be fitted concurrently
+        OT::UnsignedInteger total_degree = ioption(_name="algo.total-degree");
+        double q_norm = doption(_name="algo.q-norm");
+        std::string poly_engine = soption(_name="algo.poly-engine");
+        std::vector<ChaosContext> contexts;
+        std::vector<ChaosDesignMatrix> designs;
+        std::vector<StreamingChaos> streams;
+        for (int r=0; r<nrun; ++r)
+        {
+            OT::Distribution distribution = independentDistribution( composed_distribution );
+            contexts.emplace_back( distribution, chaosBasis( distribution, q_norm ), total_degree );
+            if ( poly_engine == "design-matrix" )
+                designs.emplace_back( input_samples[r], distribution, contexts[r].basis(), total_degree );
+            else if ( poly_engine == "streaming" )
             {
-                Feel::cout << tc::bold << tc::red << "Run " << r+1 << " over " << nrun << " with sample of size " << sampling_size << tc::reset << std::endl;
-                OT::Sample input_sample = composed_distribution.getSample(sampling_size);
-                OT::Sample output_sample = output(input_sample, plugin[0], time_crb, online_tol, rbDim);
-                OT::FunctionalChaosAlgorithm polynomialChaosAlgorithm = OT::FunctionalChaosAlgorithm(input_sample, output_sample);
+                streams.emplace_back( distribution, contexts[r].basis(), total_degree );
+                streams.back().add( input_samples[r], output_samples[r] );
+            }
+        }
+        size_t stream_segment = std::max( ioption(_name="algo.poly-stream-segment"), 1 );
+        double stream_tol = doption(_name="algo.poly-stream-tol");
+        size_t nrun_threads = threadCount( ioption(_name="algo.nrun-threads") );
 
-                polynomialChaosAlgorithm.run();
-                OT::FunctionalChaosResult polynomialChaosResult = polynomialChaosAlgorithm.getResult();
+        // fit of the chaos of the run r, new_input being its new samples, whose indices are added to run_res
+        // and whose first order indices are returned
+        auto fitRun = [&]( int r, OT::Sample const& new_input, Results& run_res ) {
+            OT::Point first_order(dim), total_order(dim);
+            // only the rows of the new samples are evaluated
+            if ( !designs.empty() )
+                designs[r].append( new_input );
+            if ( !streams.empty() && streams[r].ready() )
+                std::tie( first_order, total_order ) = streams[r].sobolIndices();
+            else if ( !designs.empty() && designs[r].determined() )
+                std::tie( first_order, total_order ) = designs[r].sobolIndices( output_samples[r] );
+            else
+            {
+                // sparse chaos, also used by the least squares engines while there are not more samples than terms
+                OT::FunctionalChaosResult polynomialChaosResult = contexts[r].fit( input_samples[r], output_samples[r] );
                 OT::FunctionalChaosSobolIndices sensitivityAnalysis = OT::FunctionalChaosSobolIndices(polynomialChaosResult);
                 for (size_t i=0; i<dim; ++i)
                 {
-                    indices(r, i) = sensitivityAnalysis.getSobolIndex(i);
-                    o1 = sensitivityAnalysis.getSobolIndex(i);
-                    ot = sensitivityAnalysis.getSobolTotalIndex(i);
-                    if ( o1 > ot )
+                    first_order[i] = sensitivityAnalysis.getSobolIndex(i);
+                    total_order[i] = sensitivityAnalysis.getSobolTotalIndex(i);
+                }
+            }
+            for (size_t i=0; i<dim; ++i)
+            {
+                if ( first_order[i] > total_order[i] )
+                {
+                    Feel::cout << tc::red << "Warning: o1 > ot" << tc::reset << std::endl;
+                    throw std::logic_error("Issue in computing sobol indices");
+                }
+                run_res.setIndice( first_order[i], i, 1 );
+                run_res.setIndice( total_order[i], i, 0 );
+            }
+            return first_order;
+        };
+        auto saveCheckpoint = [&]( int next_run ) {
+            checkpoint->setSample( "indices", indices );
+            std::ostringstream results;
+            res.save( results );
+            checkpoint->set( "results", results.str() );
+            checkpoint->set( "sampling-size", sampling_size );
+            checkpoint->set( "n-evaluations", n_evaluations );
+            checkpoint->set( "next-run", next_run );
+            checkpoint->saveRandomState();
+            checkpoint->commit();
+        };
+
+        while ( !stop )
+        {
+            if ( first_run == 0 )
+                res.reset();
+            if ( !streams.empty() )
+            {
+                for (int r=first_run; r<nrun; ++r)
+                {
+                    size_t n_new = sampling_size - input_samples[r].getSize();
+                    Feel::cout << tc::bold << tc::red << "Run " << r+1 << " over " << nrun << " with sample of size " << sampling_size
+                        << " (" << n_new << " new samples)" << tc::reset << std::endl;
+                    OT::Sample new_input = samplers[r].generate(n_new);
+
+                    // the chaos is updated with each segment, while the next one is evaluated unless the evaluation
+                    // may stop, in which case it stops right after the segment whose indices moved by less than algo.poly-stream-tol
+                    StreamingChaos& stream = streams[r];
+                    OT::Point previous;
+                    OT::Sample new_output = evaluator.output( new_input, stream_segment, [&]( size_t begin, size_t end, OT::Sample const& Y ) {
+                        stream.add( OT::Sample( new_input, begin, end ), Y );
+                        if ( !stream.ready() )
+                            return true;
+                        auto [first_order, total_order] = stream.sobolIndices();
+                        OT::Point current( first_order );
+                        current.add( total_order );
+                        bool stable = previous.getDimension() > 0 && ( current - previous ).normInf() < stream_tol;
+                        previous = current;
+                        return !stable;
+                    }, stream_tol <= 0 );
+                    if ( new_output.getSize() < n_new )
                     {
-                        Feel::cout << tc::red << "Warning: o1 > ot" << tc::reset << std::endl;
-                        throw std::logic_error("Issue in computing sobol indices");
+                        Feel::cout << tc::cyan << "Indices stable after " << new_output.getSize() << " new samples" << tc::reset << std::endl;
+                        new_input = OT::Sample( new_input, 0, new_output.getSize() );
+                        OT::Point shift = samplers[r].shift();
+                        samplers[r].restore( input_samples[r].getSize() + new_input.getSize(), shift );
+                        n_new = new_input.getSize();
+                    }
+                    output_samples[r].add( new_output );
+                    input_samples[r].add( new_input );
+                    n_evaluations += n_new;
+                    indices[r] = fitRun( r, new_input, res );
+
+                    if ( checkpoint )
+                    {
+                        checkpoint->saveSample( "input-" + std::to_string(r), input_samples[r] );
+                        checkpoint->saveSample( "output-" + std::to_string(r), output_samples[r] );
+                        saveCheckpoint( r+1 );
                     }
-                    res.setIndice( o1, i, 1 );
-                    res.setIndice( ot, i, 0 );
                 }
             }
+            else if ( first_run < nrun )
+            {
+                // the new samples of all the runs are generated in order and evaluated at once
+                std::vector<OT::Sample> new_inputs;
+                OT::Sample all_inputs( 0, dim );
+                for (int r=first_run; r<nrun; ++r)
+                {
+                    new_inputs.push_back( samplers[r].generate( sampling_size - input_samples[r].getSize() ) );
+                    all_inputs.add( new_inputs.back() );
+                }
+                all_inputs.setDescription( composed_distribution.getDescription() );
+                Feel::cout << tc::bold << tc::red << "Runs " << first_run+1 << " to " << nrun << " with samples of size " << sampling_size
+                    << " (" << all_inputs.getSize() << " new samples)" << tc::reset << std::endl;
+                OT::Sample all_outputs = evaluator.output( all_inputs );
+                n_evaluations += all_inputs.getSize();
+                for (size_t k = 0, begin = 0; k < new_inputs.size(); begin += new_inputs[k].getSize(), ++k)
+                {
+                    input_samples[first_run + k].add( new_inputs[k] );
+                    output_samples[first_run + k].add( OT::Sample( all_outputs, begin, begin + new_inputs[k].getSize() ) );
+                }
+
+                // the runs are fitted concurrently, each one in its own results, merged in order afterwards
+                std::vector<Results> run_results( new_inputs.size(), Results( dim, tableRowHeader, "polynomial-chaos", sampling_size ) );
+                std::vector<OT::Point> run_indices( new_inputs.size() );
+                tic();
+                parallelFor( new_inputs.size(), nrun_threads, 1, [&]( size_t, size_t begin, size_t end ) {
+                    for (size_t k = begin; k < end; ++k)
+                        run_indices[k] = fitRun( first_run + k, new_inputs[k], run_results[k] );
+                } );
+                toc("fit of the runs");
+                for (size_t k = 0; k < run_results.size(); ++k)
+                {
+                    indices[first_run + k] = run_indices[k];
+                    res.merge( run_results[k] );
+                }
+
+                if ( checkpoint )
+                {
+                    for (int r=first_run; r<nrun; ++r)
+                    {
+                        checkpoint->saveSample( "input-" + std::to_string(r), input_samples[r] );
+                        checkpoint->saveSample( "output-" + std::to_string(r), output_samples[r] );
+                    }
+                    saveCheckpoint( nrun );
+                }
+            }
+            first_run = 0;
             std::cout << "indices = \n" << indices << std::endl;
+            Feel::cout << "number of model evaluations so far : " << n_evaluations << std::endl;
 
-            OT::Scalar std_max = indices.computeStandardDeviation().normInf();
+            // standard deviation of the first order indices over the runs, from the merged statistics
+            OT::Scalar std_max = res.getStandardDeviation( 1 ).normInf();
             Feel::cout << tc::green << tc::bold << "max diff = " << std_max << " (tol=" << adapt_tol << ")" << tc::reset << std::endl;
             if ( std_max < adapt_tol )
-            {
-                res.normalize(nrun);
                 stop = true;
-            }
             else
             {
                 sampling_size *= 2;
@@ -385,16 +1047,66 @@ int main( int argc, char** argv )
 
         ( "parameter", po::value<std::vector<std::string> >()->multitoken(), "database filename" )
         ( "sampling.size", po::value<int>()->default_value( 2000 ), "size of sampling" )
-        ( "sampling.type", po::value<std::string>()->default_value( "random" ), "type of sampling" )
+        ( "sampling.type", po::value<std::string>()->default_value( "random" ), "type of sampling : random, philox (counter-based random numbers, generated on all the hardware threads), lhs, sobol or halton (randomly shifted sequences)" )
+        ( "sampling.seed", po::value<int>()->default_value( 0 ), "seed of the random generator, the designs being the same from one run to the other for a given seed (0 to seed with the time)" )
+        ( "sampling.replicates", po::value<int>()->default_value( 1 ), "number of independent replicates of the Saltelli design, the intervals being computed from their spread when greater than 1" )
+        ( "sampling.threads", po::value<int>()->default_value( 1 ), "number of threads used to compute the outputs, each one loading its own plugin (0 for all the hardware threads)" )
+        ( "sampling.block-size", po::value<int>()->default_value( 1 ), "number of parameters dispatched to the online code with a single call to the plugin (the reduced problems are still solved one parameter at a time)" )
+        ( "sampling.mpi", po::value<bool>()->default_value( false ), "distribute the computation of the outputs over the MPI ranks, rank 0 being the master" )
+        ( "sampling.mpi-min-chunk", po::value<int>()->default_value( 16 ), "minimal number of samples sent at once to an MPI worker" )
+        ( "sampling.mpi-max-chunk", po::value<int>()->default_value( 0 ), "maximal number of samples sent at once to an MPI worker (0 for no limit)" )
         ( "rb-dim", po::value<int>()->default_value( -1 ), "reduced basis dimension used (-1 use the max dim)" )
+        ( "hybrid.error-threshold", po::value<double>()->default_value( 0 ), "maximal error bound of the outputs of the reduced basis, the others being evaluated again with the sizes of hybrid.rb-dims (0 to disable)" )
+        ( "hybrid.rb-dims", po::value<std::vector<int> >()->multitoken(), "increasing sizes of the reduced basis, larger than rb-dim (-1 for the largest one), tried in turn for the outputs above hybrid.error-threshold (default: the largest basis)" )
+        ( "cache.enable", po::value<bool>()->default_value( false ), "look up the outputs in a persistent cache before running the online code" )
+        ( "cache.directory", po::value<std::string>()->default_value( "${repository}/crbdb/cache" ), "directory of the persistent cache of the outputs" )
+        ( "store.directory", po::value<std::string>()->default_value( "" ), "directory where the evaluated samples, outputs and online times are appended (empty to disable)" )
         ( "output_results.save.path", po::value<std::string>(), "output_results.save.path" )
+        ( "checkpoint.directory", po::value<std::string>()->default_value( "" ), "directory where the state of the run is saved (empty to disable)" )
+        ( "checkpoint.interval", po::value<int>()->default_value( 10000 ), "number of outputs computed between two checkpoints of a design" )
+        ( "checkpoint.resume", po::value<bool>()->default_value( false ), "resume the run saved in checkpoint.directory" )
 
         ( "algo.poly", po::value<bool>()->default_value(true), "use polynomial chaos" )
+        ( "algo.second-order", po::value<bool>()->default_value(false), "compute the second order indices with the Saltelli method, the design of size N(2d+2) reusing the first order evaluations" )
+        ( "convergence.tol", po::value<double>()->default_value( 0 ), "width of the confidence intervals under which the Saltelli and bootstrap methods stop adding samples (0 to use sampling.size only)" )
+        ( "convergence.batch-size", po::value<int>()->default_value( 0 ), "number of samples added by each batch until convergence.tol is reached (0 for sampling.size)" )
+        ( "convergence.max-size", po::value<int>()->default_value( 100000 ), "maximal number of samples with convergence.tol" )
+        ( "algo.multi-fidelity", po::value<bool>()->default_value(false), "use the Saltelli method with a low fidelity model (mf.rb-dim-low) as control variate" )
+        ( "mf.rb-dim-low", po::value<int>()->default_value( 5 ), "reduced basis dimension of the low fidelity model" )
+        ( "mf.pilot-size", po::value<int>()->default_value( 100 ), "number of base samples of the pilot run measuring the costs and the correlation of the two models" )
+        ( "mf.cost-size", po::value<int>()->default_value( 10 ), "number of samples of the pilot run evaluated again by the online code of each fidelity to measure its cost" )
+        ( "mf.max-ratio", po::value<double>()->default_value( 100 ), "maximal ratio between the numbers of low and high fidelity samples" )
+        ( "algo.streaming", po::value<bool>()->default_value(false), "compute the indices in one pass, the Saltelli design being generated and evaluated by blocks" )
+        ( "streaming.block-size", po::value<int>()->default_value( 1000 ), "number of base samples of each block of the streaming algorithm" )
+        ( "streaming.estimator", po::value<std::string>()->default_value( "jansen" ), "estimator of the streaming algorithm : saltelli, jansen or martinez" )
+        ( "algo.pipeline", po::value<bool>()->default_value( false ), "with algo.streaming, generate, evaluate and fold the blocks in three concurrent stages" )
+        ( "pipeline.depth", po::value<int>()->default_value( 2 ), "number of blocks waiting between two stages of the pipeline" )
         ( "algo.bootstrap", po::value<bool>()->default_value(true), "use polynomial chaos and bootstrap" )
         ( "algo.nrun", po::value<int>()->default_value(5), "number to run algorithm" )
+        ( "algo.nrun-threads", po::value<int>()->default_value(0), "number of threads fitting the runs of the polynomial chaos method concurrently (0 for all the hardware threads)" )
         ( "adapt.tol", po::value<double>()->default_value(0.01), "tolerance for adaptative algoritmh" )
         ( "algo.bootstrap-size", po::value<int>()->default_value(100), "bootstrap size for sensitivity analysis" )
+        ( "algo.bootstrap-threads", po::value<int>()->default_value(0), "number of threads computing the bootstrap replicates (0 for all the hardware threads)" )
+        ( "algo.total-degree", po::value<int>()->default_value( 3 ), "total degree of the polynomial chaos of the bootstrap and polynomial chaos methods" )
+        ( "algo.poly-engine", po::value<std::string>()->default_value( "openturns" ), "fit of the polynomial chaos method : openturns (sparse chaos), design-matrix (least squares on the basis evaluated incrementally) or streaming (least squares updated during the evaluations)" )
+        ( "algo.poly-stream-segment", po::value<int>()->default_value( 100 ), "number of samples evaluated between two updates of the streaming chaos" )
+        ( "algo.poly-stream-tol", po::value<double>()->default_value( 0 ), "the streaming chaos stops the evaluation of a batch once the indices move by less than this between two segments (0 to evaluate the whole batch)" )
+        ( "algo.adaptive-degree", po::value<bool>()->default_value( false ), "select the total degree of the chaos, up to algo.max-degree, by its leave-one-out error" )
+        ( "algo.max-degree", po::value<int>()->default_value( 8 ), "maximal total degree tried with algo.adaptive-degree" )
+        ( "algo.q-norm", po::value<double>()->default_value( 1 ), "q-norm of the hyperbolic truncation of the chaos basis, in (0, 1]" )
+        ( "algo.bootstrap-engine", po::value<std::string>()->default_value( "refit" ), "bootstrap of the chaos : refit (sparse chaos fitted on each replicate) or design-matrix (weighted least squares on the basis evaluated once)" )
+        ( "algo.bootstrap-fixed-sparsity", po::value<bool>()->default_value( true ), "with the design-matrix engine, keep the terms selected on the whole sample, else use all the terms of the basis" )
+        ( "algo.bootstrap-seed", po::value<int>()->default_value(-1), "seed of the bootstrap selections, the indices only depending on it and not on the number of threads (-1 for sampling.seed, or a seed drawn from the random generator if it is 0)" )
         ( "algo.check-meta-model", po::value<bool>()->default_value(false), "Check the metamodel" )
+        ( "metamodel.export", po::value<std::string>()->default_value( "" ), "file where the polynomial chaos of the bootstrap method is exported, to be read by ChaosMetamodel (empty to disable)" )
+        ( "metamodel.export-code", po::value<std::string>()->default_value( "" ), "file where the C++ code evaluating the polynomial chaos is generated (empty to disable)" )
+        ( "metamodel.mc-size", po::value<int>()->default_value( 0 ), "number of base samples of the Monte Carlo estimation of the indices on the polynomial chaos (0 to disable)" )
+        ( "metamodel.mc-block-size", po::value<int>()->default_value( 100000 ), "number of base samples of each block of the Monte Carlo on the polynomial chaos" )
+        ( "metamodel.threads", po::value<int>()->default_value( 0 ), "number of threads evaluating the polynomial chaos (0 for all the hardware threads)" )
+        ( "algo.validation", po::value<std::string>()->default_value( "loo" ), "validation of the metamodel : loo or kfold (cross-validation on the training sample) or test (new evaluations)" )
+        ( "algo.validation-folds", po::value<int>()->default_value( 5 ), "number of folds of the kfold validation" )
+        ( "algo.validation-size", po::value<int>()->default_value( 1000 ), "size of the test sample of the test validation" )
+        ( "algo.validation-seed", po::value<int>()->default_value( 0 ), "seed of the test sample of the test validation" )
 
         ( "query", po::value<std::string>(), "query string for mongodb DB feelpp.crbdb" )
         ( "compare", po::value<std::string>(), "compare results from query in mongodb DB feelpp.crbdb" )
@@ -417,10 +1129,114 @@ int main( int argc, char** argv )
                      _desc_lib = crbonlinerunliboptions.add( feel_options() ),
                      _about = makeAbout() );
 
-    OT::RandomGenerator::SetSeed( ::time(NULL) );
-    plugin_ptr_t plugin = loadPlugin();
-    // runCrbOnline( { plugin } );
-    runSensitivityAnalysis( { plugin }, ioption(_name="sampling.size"), false );
+    int seed = ioption(_name="sampling.seed");
+    OT::RandomGenerator::SetSeed( seed > 0 ? seed : ::time(NULL) );
+    double online_tol = doption(_name="crb.online-tolerance");
+    int rbDim = ioption(_name="rb-dim");
+
+    // each thread evaluates the outputs with its own plugin, hence its own online workspace
+    size_t nthreads = threadCount( ioption(_name="sampling.threads") );
+    std::vector<plugin_ptr_t> plugins;
+    std::string dbRepository;
+    for (size_t t = 0; t < nthreads; ++t)
+        plugins.push_back( loadPlugin( &dbRepository ) );
+    Evaluator evaluator( plugins, online_tol, rbDim );
+    evaluator.setBlockSize( ioption(_name="sampling.block-size") );
+
+    // the outputs whose error bound is above the threshold are evaluated again with larger reduced bases
+    std::string hybridKey;
+    if ( doption(_name="hybrid.error-threshold") > 0 )
+    {
+        std::vector<int> rbDims;
+        if ( Environment::vm().count( "hybrid.rb-dims" ) )
+            rbDims = Environment::vm()["hybrid.rb-dims"].as<std::vector<int> >();
+        else if ( rbDim != -1 )
+            rbDims = { -1 };
+        // the ladder is checked on all the ranks, the MPI workers certifying the outputs they evaluate
+        evaluator.setErrorThreshold( doption(_name="hybrid.error-threshold"), rbDims );
+        std::ostringstream key;
+        key << "|error-threshold=" << doption(_name="hybrid.error-threshold") << "|rb-dims=";
+        for ( int rb : rbDims )
+            key << rb << ",";
+        hybridKey = key.str();
+        if ( rbDims.empty() )
+            Feel::cout << tc::red << "Warning: rb-dim is already the largest reduced basis, the outputs above the error threshold "
+                       << doption(_name="hybrid.error-threshold") << " are only counted" << tc::reset << std::endl;
+        else
+            Feel::cout << "Certify the outputs with an error bound below " << doption(_name="hybrid.error-threshold")
+                       << ", escalating over " << rbDims.size() << " larger reduced basis" << std::endl;
+    }
+
+    // the outputs are looked up in the cache by the rank running the analysis only
+    if ( boption(_name="cache.enable") && Environment::isMasterRank() )
+    {
+        try
+        {
+            std::vector<int> rbDims = { rbDim };
+            if ( boption(_name="algo.multi-fidelity") && ioption(_name="mf.rb-dim-low") != rbDim )
+                rbDims.push_back( ioption(_name="mf.rb-dim-low") );
+            for ( int rb : rbDims )
+            {
+                auto cache = std::make_shared<EvaluationCache>( Environment::expand( soption(_name="cache.directory") ),
+                    EvaluationCache::modelKey( dbRepository, rb, online_tol ) + ( rb == rbDim ? hybridKey : "" ),
+                    evaluator.parameterSpace()->dimension() );
+                Feel::cout << "Use cache " << cache->path() << " (" << cache->size() << " entries)" << std::endl;
+                evaluator.setCache( cache, rb );
+            }
+        }
+        catch ( std::exception const& e )
+        {
+            Feel::cout << tc::red << "Cache disabled: " << e.what() << tc::reset << std::endl;
+        }
+    }
+    if ( !soption(_name="store.directory").empty() && Environment::isMasterRank() )
+    {
+        auto store = std::make_shared<SampleStore>( Environment::expand( soption(_name="store.directory") ), evaluator.parameterSpace()->parameterNames() );
+        Feel::cout << "Store samples in " << store->directory() << " (" << store->size() << " rows)" << std::endl;
+        evaluator.setStore( store );
+    }
+
+    // rank 0 runs the analysis and hands out the samples to evaluate to the other ranks
+    std::shared_ptr<MPIScheduler> scheduler;
+    if ( boption(_name="sampling.mpi") && Environment::numberOfProcessors() > 1 )
+    {
+        scheduler = std::make_shared<MPIScheduler>( MPI_COMM_WORLD, ioption(_name="sampling.mpi-min-chunk"), ioption(_name="sampling.mpi-max-chunk") );
+        evaluator.setScheduler( scheduler );
+    }
+
+    if ( scheduler && !scheduler->isMaster() )
+    {
+        evaluator.serve();
+        return 0;
+    }
+
+    // the workers are released however the analysis ends, otherwise they stay blocked in serve()
+    struct WorkersRelease
+    {
+        std::shared_ptr<MPIScheduler> scheduler;
+        ~WorkersRelease() { if ( scheduler ) scheduler->stop(); }
+    };
+
+    try
+    {
+        WorkersRelease release{ scheduler };
+
+        std::shared_ptr<Checkpoint> checkpoint;
+        if ( !soption(_name="checkpoint.directory").empty() )
+        {
+            checkpoint = std::make_shared<Checkpoint>( Environment::expand( soption(_name="checkpoint.directory") ),
+                boption(_name="checkpoint.resume"), ioption(_name="checkpoint.interval") );
+            Feel::cout << ( checkpoint->resumed() ? "Resume the run saved in " : "Save the state of the run in " ) << checkpoint->directory() << std::endl;
+        }
+
+        // runCrbOnline( { plugin } );
+        runSensitivityAnalysis( evaluator, ioption(_name="sampling.size"), boption(_name="algo.second-order"), checkpoint );
+    }
+    catch ( std::exception const& e )
+    {
+        Feel::cout << tc::red << "Sensitivity analysis failed: " << e.what() << tc::reset << std::endl;
+        return 1;
+    }
 
     Feel::cout << tc::green << "Done ✓" << tc::reset << std::endl;
     return 0;
@@ -0,0 +1,251 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file BoundedQueue.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Bounded lock-free single producer single consumer queue, and a three stage pipeline built on it
+//!
+
+#ifndef __BOUNDED_QUEUE_HPP__
+#define __BOUNDED_QUEUE_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @brief Bounded queue between one producer thread and one consumer thread
+ *
+ * The slots form a ring indexed by two monotonic counters, the producer only
+ * writing the tail and the consumer only writing the head, so that no lock is
+ * needed. push waits while the queue is full, which slows the producer down to
+ * the pace of the consumer (back-pressure), and pop waits while it is empty.
+ * Once closed, push fails and pop returns the remaining items then fails;
+ * once cancelled, both fail at once.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @brief Construct a new BoundedQueue object
+     *
+     * @param capacity maximal number of items in the queue
+     */
+    explicit BoundedQueue( size_t capacity ) :
+        M_slots( std::max<size_t>( capacity, 1 ) ), M_head(0), M_tail(0), M_closed(false), M_cancelled(false)
+    {}
+
+    size_t capacity() const { return M_slots.size(); };
+
+    /**
+     * @brief Add an item if the queue is not full, to be called by the producer only
+     *
+     * @return false if the queue is full or closed
+     */
+    bool tryPush( T& item )
+    {
+        if ( M_closed.load( std::memory_order_acquire ) )
+            return false;
+        size_t tail = M_tail.load( std::memory_order_relaxed );
+        if ( tail - M_head.load( std::memory_order_acquire ) == M_slots.size() )
+            return false;
+        M_slots[tail % M_slots.size()] = std::move( item );
+        M_tail.store( tail + 1, std::memory_order_release );
+        return true;
+    }
+
+    /**
+     * @brief Remove an item if the queue is not empty, to be called by the consumer only
+     *
+     * @return the item, or nothing if the queue is empty
+     */
+    std::optional<T> tryPop()
+    {
+        size_t head = M_head.load( std::memory_order_relaxed );
+        if ( head == M_tail.load( std::memory_order_acquire ) )
+            return std::nullopt;
+        std::optional<T> item( std::move( M_slots[head % M_slots.size()] ) );
+        M_head.store( head + 1, std::memory_order_release );
+        return item;
+    }
+
+    /**
+     * @brief Add an item, waiting while the queue is full
+     *
+     * @return false if the queue has been closed, the item being left unchanged
+     */
+    bool push( T item )
+    {
+        for ( size_t spin = 0; !tryPush( item ); ++spin )
+        {
+            if ( M_closed.load( std::memory_order_acquire ) )
+                return false;
+            wait( spin );
+        }
+        return true;
+    }
+
+    /**
+     * @brief Remove an item, waiting while the queue is empty
+     *
+     * @return the item, or nothing once the queue is closed and empty
+     */
+    std::optional<T> pop()
+    {
+        for ( size_t spin = 0; ; ++spin )
+        {
+            // the closed flag is read before the items, so that the items pushed before close are not lost
+            bool closed = M_closed.load( std::memory_order_acquire );
+            if ( M_cancelled.load( std::memory_order_acquire ) )
+                return std::nullopt;
+            if ( std::optional<T> item = tryPop() )
+                return item;
+            if ( closed )
+                return std::nullopt;
+            wait( spin );
+        }
+    }
+
+    /**
+     * @brief Close the queue, from any of the two threads
+     */
+    void close() { M_closed.store( true, std::memory_order_release ); }
+
+    /**
+     * @brief Close the queue and drop its items, from any of the two threads
+     */
+    void cancel()
+    {
+        M_cancelled.store( true, std::memory_order_release );
+        close();
+    }
+
+private:
+    /**
+     * @brief Spin first, then yield, then sleep, as the wait gets longer
+     */
+    static void wait( size_t spin )
+    {
+        if ( spin < 64 )
+            return;
+        if ( spin < 256 )
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+    }
+
+    std::vector<T> M_slots;
+    alignas(64) std::atomic<size_t> M_head;     // next item to pop, written by the consumer
+    alignas(64) std::atomic<size_t> M_tail;     // next slot to push, written by the producer
+    std::atomic<bool> M_closed;
+    std::atomic<bool> M_cancelled;
+};
+
+/**
+ * @brief Run generate, evaluate and analyse as three concurrent stages connected by bounded queues
+ *
+ * generate( block ) fills the next block and returns false once there is no more
+ * block, on its own thread; evaluate( block ) runs on the calling thread, so that
+ * it can use MPI or print; analyse( block ) consumes the blocks in order, on its
+ * own thread. Each queue holds at most capacity blocks, so that at most
+ * 2 * capacity + 3 blocks are alive at once.
+ * When a stage throws, the queues are cancelled, the other stages stop after their
+ * current block, and the first exception is rethrown once the threads are joined.
+ *
+ * @param capacity number of blocks of each queue
+ * @param generate function generating a block
+ * @param evaluate function evaluating a block
+ * @param analyse function analysing a block
+ */
+template <typename Block, typename Generate, typename Evaluate, typename Analyse>
+void runPipeline( size_t capacity, Generate&& generate, Evaluate&& evaluate, Analyse&& analyse )
+{
+    BoundedQueue<Block> generated( capacity ), evaluated( capacity );
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto fail = [&]() {
+        {
+            std::lock_guard<std::mutex> lock( error_mutex );
+            if ( !error )
+                error = std::current_exception();
+        }
+        generated.cancel();
+        evaluated.cancel();
+    };
+
+    std::thread generator( [&]() {
+        try
+        {
+            Block block;
+            while ( generate( block ) && generated.push( std::move( block ) ) )
+                block = Block();
+        }
+        catch ( ... )
+        {
+            fail();
+        }
+        generated.close();
+    } );
+    std::thread analyser( [&]() {
+        try
+        {
+            while ( std::optional<Block> block = evaluated.pop() )
+                analyse( *block );
+        }
+        catch ( ... )
+        {
+            fail();
+        }
+        // the evaluation stops pushing if the analysis stopped early
+        evaluated.close();
+    } );
+
+    try
+    {
+        while ( std::optional<Block> block = generated.pop() )
+        {
+            evaluate( *block );
+            if ( !evaluated.push( std::move( *block ) ) )
+                break;
+        }
+    }
+    catch ( ... )
+    {
+        fail();
+    }
+    generated.close();
+    evaluated.close();
+    generator.join();
+    analyser.join();
+    if ( error )
+        std::rethrow_exception( error );
+}
+
+
+#endif // __BOUNDED_QUEUE_HPP__
@@ -0,0 +1,301 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file EvaluationCache.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Persistent cache of the outputs of a reduced model, shared by the SA and DSA applications
+//!
+
+#ifndef __EVALUATION_CACHE_HPP__
+#define __EVALUATION_CACHE_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+
+/**
+ * @brief Memory-mapped hash table mu -> outputs
+ *
+ * One file is used per model key (CRB database, reduced basis dimension and
+ * online tolerance), named after the hash of the key. The table uses open
+ * addressing with linear probing on fixed-size slots, and is rehashed in a
+ * file twice as large when half full. Parameters are compared bitwise.
+ *
+ * Several processes can use the same cache at once: the lookups take a shared
+ * lock and the insertions an exclusive lock on a separate lock file. A rehash
+ * marks the old file as replaced before renaming the new one over it, so that
+ * the other processes map the new file again on their next access.
+ */
+class EvaluationCache
+{
+public:
+    /**
+     * @brief Build the key identifying a reduced model
+     *
+     * The database is identified by its repository, named after its uuid, and
+     * by the last modification time of its files, so that a database trained
+     * again in place gets a new cache.
+     *
+     * @param db repository of the CRB database
+     * @param rbDim size of the reduced basis
+     * @param online_tol online tolerance
+     * @return std::string key of the model
+     */
+    static std::string modelKey( std::string const& db, int rbDim, double online_tol )
+    {
+        std::ostringstream key;
+        key.precision( 17 );
+        key << db << "|modified=" << lastModified( db ) << "|rb-dim=" << rbDim << "|online-tol=" << online_tol;
+        return key.str();
+    }
+
+    /**
+     * @brief Last modification time of the files of a directory, 0 if it does not exist
+     *
+     * @param directory directory, explored recursively
+     * @return std::int64_t time in the units of the file clock, relative to its epoch
+     */
+    static std::int64_t lastModified( std::string const& directory )
+    {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        // the epoch of the file clock may be later than the modification times
+        std::int64_t last = std::numeric_limits<std::int64_t>::min();
+        if ( !fs::is_directory( directory, ec ) )
+            return 0;
+        for ( fs::recursive_directory_iterator it( directory, ec ), end; !ec && it != end; it.increment( ec ) )
+        {
+            // the files of a cache stored inside the repository do not change the model
+            std::string ext = it->path().extension().string();
+            if ( !it->is_regular_file( ec ) || ext == ".cache" || ext == ".lock" || ext == ".tmp" )
+                continue;
+            last = std::max<std::int64_t>( last, it->last_write_time( ec ).time_since_epoch().count() );
+        }
+        return last == std::numeric_limits<std::int64_t>::min() ? 0 : last;
+    }
+
+    /**
+     * @brief Open the cache of a model, creating it if needed
+     *
+     * @param directory directory where the cache files are stored
+     * @param key key of the model, from modelKey
+     * @param dim dimension of the parameters
+     * @param nout number of outputs stored per parameter
+     */
+    EvaluationCache( std::string const& directory, std::string const& key, size_t dim, size_t nout = 1 ) :
+        M_key(hash( key.data(), key.size() )), M_dim(dim), M_nout(nout), M_stride(1 + dim + nout)
+    {
+        std::filesystem::create_directories( directory );
+        std::ostringstream filename;
+        filename << std::hex << M_key << ".cache";
+        M_path = ( std::filesystem::path( directory ) / filename.str() ).string();
+        M_lock = std::make_unique<FileLock>( M_path + ".lock" );
+
+        FileLockGuard guard( *M_lock, true );
+        M_file = MappedFile( M_path );
+        if ( M_file.size() == 0 )
+        {
+            initialize( M_file, INITIAL_CAPACITY );
+            M_file.sync();
+        }
+        Header const* h = header();
+        if ( std::memcmp( h->magic, MAGIC, 8 ) != 0 || h->key != M_key || h->dim != M_dim || h->nout != M_nout )
+            throw std::runtime_error( "EvaluationCache: " + M_path + " is not a cache of this model" );
+    };
+
+    // Accessors
+    std::string const& path() const { return M_path; };
+    size_t size() { FileLockGuard guard( *M_lock, false ); refresh(); return header()->count; };
+    size_t capacity() { FileLockGuard guard( *M_lock, false ); refresh(); return header()->capacity; };
+
+    /**
+     * @brief Look up the outputs of a parameter
+     *
+     * @param mu parameter, of size dim
+     * @param out outputs, of size nout, written only if the parameter is found
+     * @return true if the parameter is in the cache
+     */
+    bool find( double const* mu, double* out )
+    {
+        FileLockGuard guard( *M_lock, false );
+        refresh();
+        std::uint64_t h = hash( mu, M_dim * sizeof(double) );
+        size_t mask = header()->capacity - 1;
+        for ( size_t s = h & mask; ; s = ( s + 1 ) & mask )
+        {
+            double const* slot = this->slot( s );
+            std::uint64_t tag = tagOf( slot );
+            if ( tag == 0 )
+                return false;
+            if ( tag == h && std::memcmp( slot + 1, mu, M_dim * sizeof(double) ) == 0 )
+            {
+                std::memcpy( out, slot + 1 + M_dim, M_nout * sizeof(double) );
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @brief Store the outputs of a parameter, replacing any previous value
+     *
+     * @param mu parameter, of size dim
+     * @param out outputs, of size nout
+     */
+    void insert( double const* mu, double const* out )
+    {
+        FileLockGuard guard( *M_lock, true );
+        refresh();
+        if ( 2 * ( header()->count + 1 ) > header()->capacity )
+            grow();
+        store( M_file, hash( mu, M_dim * sizeof(double) ), mu, out );
+    }
+
+    /**
+     * @brief Write the cache back to the disk
+     */
+    void sync()
+    {
+        FileLockGuard guard( *M_lock, true );
+        refresh();
+        M_file.sync();
+    }
+
+private:
+    static constexpr char MAGIC[8] = { 'M', 'O', 'R', 'C', 'A', 'C', 'H', 'E' };
+    static constexpr size_t INITIAL_CAPACITY = 1024;
+
+    struct Header
+    {
+        char magic[8];
+        std::uint64_t key;
+        std::uint64_t dim;
+        std::uint64_t nout;
+        std::uint64_t capacity;
+        std::uint64_t count;
+        std::uint64_t replaced;     // set once the file has been replaced by a larger one
+        std::uint64_t reserved;
+    };
+
+    /**
+     * @brief FNV-1a hash, never 0 so that 0 marks the empty slots
+     */
+    static std::uint64_t hash( void const* data, size_t size )
+    {
+        unsigned char const* p = static_cast<unsigned char const*>( data );
+        std::uint64_t h = 14695981039346656037ULL;
+        for ( size_t i = 0; i < size; ++i )
+        {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+        return h ? h : 1;
+    }
+
+    Header* header() { return reinterpret_cast<Header*>( M_file.data() ); }
+    Header const* header() const { return reinterpret_cast<Header const*>( M_file.data() ); }
+    double* slot( MappedFile& file, size_t s ) { return reinterpret_cast<double*>( file.data() + sizeof(Header) ) + s * M_stride; }
+    double const* slot( size_t s ) const { return reinterpret_cast<double const*>( M_file.data() + sizeof(Header) ) + s * M_stride; }
+    static std::uint64_t tagOf( double const* slot ) { std::uint64_t tag; std::memcpy( &tag, slot, sizeof(tag) ); return tag; }
+
+    /**
+     * @brief Map the file again if another process has replaced it, with the lock held
+     */
+    void refresh()
+    {
+        if ( header()->replaced )
+            M_file = MappedFile( M_path );
+    }
+
+    void initialize( MappedFile& file, size_t capacity )
+    {
+        file.resize( sizeof(Header) + capacity * M_stride * sizeof(double) );
+        std::memset( file.data(), 0, file.size() );
+        Header* h = reinterpret_cast<Header*>( file.data() );
+        std::memcpy( h->magic, MAGIC, 8 );
+        h->key = M_key;
+        h->dim = M_dim;
+        h->nout = M_nout;
+        h->capacity = capacity;
+        h->count = 0;
+    }
+
+    void store( MappedFile& file, std::uint64_t tag, double const* mu, double const* out )
+    {
+        Header* h = reinterpret_cast<Header*>( file.data() );
+        size_t mask = h->capacity - 1;
+        for ( size_t s = tag & mask; ; s = ( s + 1 ) & mask )
+        {
+            double* slot = this->slot( file, s );
+            std::uint64_t t = tagOf( slot );
+            if ( t == 0 || ( t == tag && std::memcmp( slot + 1, mu, M_dim * sizeof(double) ) == 0 ) )
+            {
+                if ( t == 0 )
+                    ++h->count;
+                std::memcpy( slot, &tag, sizeof(tag) );
+                std::memcpy( slot + 1, mu, M_dim * sizeof(double) );
+                std::memcpy( slot + 1 + M_dim, out, M_nout * sizeof(double) );
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Rehash the table in a file twice as large, then replace the current file, with the exclusive lock held
+     */
+    void grow()
+    {
+        size_t capacity = header()->capacity;
+        std::string tmp = M_path + ".tmp";
+        {
+            MappedFile file( tmp );
+            initialize( file, 2 * capacity );
+            for ( size_t s = 0; s < capacity; ++s )
+            {
+                double const* slot = this->slot( s );
+                std::uint64_t tag = tagOf( slot );
+                if ( tag != 0 )
+                    store( file, tag, slot + 1, slot + 1 + M_dim );
+            }
+            file.sync();
+        }
+        std::filesystem::rename( tmp, M_path );
+        header()->replaced = 1;
+        M_file.sync();
+        M_file = MappedFile( M_path );
+    }
+
+    std::uint64_t M_key;
+    size_t M_dim, M_nout, M_stride;
+    std::string M_path;
+    std::unique_ptr<FileLock> M_lock;
+    MappedFile M_file;
+};
+
+
+#endif // __EVALUATION_CACHE_HPP__
@@ -0,0 +1,197 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file MappedFile.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Read-write memory mapping of a file that can grow, and advisory lock shared between processes
+//!
+
+#ifndef __MAPPED_FILE_HPP__
+#define __MAPPED_FILE_HPP__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+class MappedFile
+{
+public:
+    MappedFile() : M_fd(-1), M_data(nullptr), M_size(0) {};
+
+    /**
+     * @brief Open (and create if needed) a file and map it in memory
+     *
+     * @param path path to the file
+     * @param minSize the file is extended with zeros to at least this size
+     */
+    MappedFile( std::string const& path, size_t minSize = 0 ) : MappedFile()
+    {
+        M_path = path;
+        M_fd = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+        if ( M_fd < 0 )
+            fail( "open" );
+        struct stat st;
+        if ( ::fstat( M_fd, &st ) != 0 )
+            fail( "fstat" );
+        resize( std::max<size_t>( st.st_size, minSize ) );
+    };
+    MappedFile( MappedFile const& ) = delete;
+    MappedFile& operator=( MappedFile const& ) = delete;
+    MappedFile( MappedFile&& other ) : MappedFile() { swap( other ); };
+    MappedFile& operator=( MappedFile&& other ) { swap( other ); return *this; };
+    ~MappedFile()
+    {
+        unmap();
+        if ( M_fd >= 0 )
+            ::close( M_fd );
+    };
+
+    // Accessors
+    bool isOpen() const { return M_fd >= 0; };
+    std::string const& path() const { return M_path; };
+    size_t size() const { return M_size; };
+    char* data() { return M_data; };
+    char const* data() const { return M_data; };
+
+    /**
+     * @brief Resize the file and map it again, the previous pointers are invalidated
+     *
+     * @param size new size in bytes
+     */
+    void resize( size_t size )
+    {
+        unmap();
+        if ( ::ftruncate( M_fd, size ) != 0 )
+            fail( "ftruncate" );
+        M_size = size;
+        if ( size == 0 )
+            return;
+        void* p = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, M_fd, 0 );
+        if ( p == MAP_FAILED )
+            fail( "mmap" );
+        M_data = static_cast<char*>( p );
+    }
+
+    /**
+     * @brief Write the modified pages back to the file
+     */
+    void sync()
+    {
+        if ( M_data && ::msync( M_data, M_size, MS_SYNC ) != 0 )
+            fail( "msync" );
+    }
+
+private:
+    void unmap()
+    {
+        if ( M_data )
+            ::munmap( M_data, M_size );
+        M_data = nullptr;
+    }
+
+    void swap( MappedFile& other )
+    {
+        std::swap( M_path, other.M_path );
+        std::swap( M_fd, other.M_fd );
+        std::swap( M_data, other.M_data );
+        std::swap( M_size, other.M_size );
+    }
+
+    [[noreturn]] void fail( std::string const& what ) const
+    {
+        throw std::runtime_error( "MappedFile: " + what + " failed on " + M_path + ": " + std::strerror( errno ) );
+    }
+
+    std::string M_path;
+    int M_fd;
+    char* M_data;
+    size_t M_size;
+};
+
+/**
+ * @brief Advisory lock on a lock file, kept open for the lifetime of the object
+ *
+ * The lock file is distinct from the data it protects, so that the data files
+ * can be replaced (renamed over) while the lock is held: the processes take the
+ * lock before opening or mapping the data again, and never see a file in the
+ * middle of its replacement.
+ */
+class FileLock
+{
+public:
+    /**
+     * @brief Open (and create if needed) the lock file
+     *
+     * @param path path to the lock file
+     */
+    explicit FileLock( std::string const& path ) : M_path(path)
+    {
+        M_fd = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+        if ( M_fd < 0 )
+            throw std::runtime_error( "FileLock: open failed on " + path + ": " + std::strerror( errno ) );
+    };
+    FileLock( FileLock const& ) = delete;
+    FileLock& operator=( FileLock const& ) = delete;
+    ~FileLock() { ::close( M_fd ); };
+
+    /**
+     * @brief Wait for the lock, shared between the readers or exclusive
+     */
+    void lock( bool exclusive )
+    {
+        while ( ::flock( M_fd, exclusive ? LOCK_EX : LOCK_SH ) != 0 )
+            if ( errno != EINTR )
+                throw std::runtime_error( "FileLock: flock failed on " + M_path + ": " + std::strerror( errno ) );
+    }
+
+    void unlock() { ::flock( M_fd, LOCK_UN ); }
+
+private:
+    std::string M_path;
+    int M_fd;
+};
+
+/**
+ * @brief Scoped lock of a FileLock
+ */
+class FileLockGuard
+{
+public:
+    FileLockGuard( FileLock& lock, bool exclusive ) : M_lock(lock) { M_lock.lock( exclusive ); };
+    FileLockGuard( FileLockGuard const& ) = delete;
+    FileLockGuard& operator=( FileLockGuard const& ) = delete;
+    ~FileLockGuard() { M_lock.unlock(); };
+
+private:
+    FileLock& M_lock;
+};
+
+
+#endif // __MAPPED_FILE_HPP__
@@ -0,0 +1,103 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file ParallelFor.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Minimal thread pool loop used to spread independent work items over worker threads
+//!
+
+#ifndef __PARALLEL_FOR_HPP__
+#define __PARALLEL_FOR_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Number of threads to use from an option value, 0 meaning all the hardware threads
+ *
+ * @param requested number of threads asked by the user
+ * @return size_t number of threads to use, at least 1
+ */
+inline size_t threadCount( int requested )
+{
+    if ( requested > 0 )
+        return requested;
+    return std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+/**
+ * @brief Run f(worker, begin, end) over [0, n) by chunks, chunks being handed out dynamically to the workers
+ *
+ * The worker index is in [0, nthreads) and is stable inside a thread, so that
+ * per-worker resources can be indexed by it. The calling thread is worker 0.
+ * The first exception thrown by a worker is rethrown once all threads are joined.
+ *
+ * @param n number of work items
+ * @param nthreads number of worker threads
+ * @param chunk number of items handed out at once
+ * @param f function called on each chunk
+ */
+template <typename Function>
+void parallelFor( size_t n, size_t nthreads, size_t chunk, Function&& f )
+{
+    chunk = std::max<size_t>( chunk, 1 );
+    nthreads = std::max<size_t>( 1, std::min( nthreads, ( n + chunk - 1 ) / chunk ) );
+    if ( nthreads == 1 )
+    {
+        if ( n > 0 )
+            f( size_t(0), size_t(0), n );
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto work = [&]( size_t worker )
+    {
+        try
+        {
+            for ( size_t begin = next.fetch_add( chunk ); begin < n; begin = next.fetch_add( chunk ) )
+                f( worker, begin, std::min( n, begin + chunk ) );
+        }
+        catch ( ... )
+        {
+            std::lock_guard<std::mutex> lock( error_mutex );
+            if ( !error )
+                error = std::current_exception();
+            next = n;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve( nthreads - 1 );
+    for ( size_t w = 1; w < nthreads; ++w )
+        threads.emplace_back( work, w );
+    work( 0 );
+    for ( auto& t : threads )
+        t.join();
+    if ( error )
+        std::rethrow_exception( error );
+}
+
+#endif // __PARALLEL_FOR_HPP__
@@ -0,0 +1,309 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file RandomStreams.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Counter-based random numbers and inverse cumulative distribution functions evaluated on blocks
+//!
+
+#ifndef __RANDOM_STREAMS_HPP__
+#define __RANDOM_STREAMS_HPP__
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if ( defined(__GNUC__) || defined(__clang__) ) && defined(__x86_64__)
+#define RANDOM_STREAMS_DISPATCH 1
+#define RANDOM_INLINE inline __attribute__((always_inline))
+#else
+#define RANDOM_STREAMS_DISPATCH 0
+#define RANDOM_INLINE inline
+#endif
+
+/**
+ * @brief Philox4x32-10 counter-based generator (Salmon et al., SC'11)
+ *
+ * The four words returned for a counter only depend on the counter and on the
+ * key, so that any draw of a stream can be computed without generating the
+ * previous ones: the draws do not depend on how they are spread over the threads
+ * or the ranks.
+ */
+class Philox
+{
+public:
+    typedef std::array<std::uint32_t, 4> counter_t;
+
+    /**
+     * @brief Construct a new Philox object
+     *
+     * @param key key of the stream
+     */
+    explicit Philox( std::uint64_t key = 0 ) :
+        M_key{ std::uint32_t( key ), std::uint32_t( key >> 32 ) }
+    {}
+
+    std::uint64_t key() const { return std::uint64_t( M_key[1] ) << 32 | M_key[0]; };
+
+    /**
+     * @brief Random words of a counter
+     */
+    counter_t operator()( counter_t c ) const
+    {
+        std::uint32_t k0 = M_key[0], k1 = M_key[1];
+        for (int round = 0; round < 10; ++round)
+        {
+            std::uint64_t p0 = std::uint64_t( 0xD2511F53u ) * c[0];
+            std::uint64_t p1 = std::uint64_t( 0xCD9E8D57u ) * c[2];
+            c = { std::uint32_t( p1 >> 32 ) ^ c[1] ^ k0, std::uint32_t( p1 ),
+                  std::uint32_t( p0 >> 32 ) ^ c[3] ^ k1, std::uint32_t( p0 ) };
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        return c;
+    }
+
+    /**
+     * @brief Two uniform numbers in (0, 1) of 53 bits, at a position of the stream
+     *
+     * @param index first coordinate of the position, the index of the point
+     * @param column second coordinate of the position
+     * @param u the two numbers
+     */
+    void uniform( std::uint64_t index, std::uint32_t column, double* u ) const
+    {
+        counter_t r = (*this)( { std::uint32_t( index ), std::uint32_t( index >> 32 ), column, 0 } );
+        u[0] = toUniform( std::uint64_t( r[0] ) << 32 | r[1] );
+        u[1] = toUniform( std::uint64_t( r[2] ) << 32 | r[3] );
+    }
+
+private:
+    static double toUniform( std::uint64_t bits )
+    {
+        return ( double( bits >> 11 ) + 0.5 ) * 0x1.0p-53;
+    }
+
+    std::array<std::uint32_t, 2> M_key;
+};
+
+namespace random_detail
+{
+RANDOM_INLINE double fromBits( std::uint64_t bits ) { double x; std::memcpy( &x, &bits, sizeof x ); return x; }
+RANDOM_INLINE std::uint64_t toBits( double x ) { std::uint64_t bits; std::memcpy( &bits, &x, sizeof x ); return bits; }
+
+// c ? a : b on the bits, both values being computed: a conditional expression whose branches compute
+// something is not vectorized, since the floating-point operations could trap
+RANDOM_INLINE double blend( bool c, double a, double b )
+{
+    std::uint64_t mask = -std::uint64_t( c );
+    return fromBits( ( toBits( a ) & mask ) | ( toBits( b ) & ~mask ) );
+}
+} // namespace random_detail
+
+/**
+ * @brief Natural logarithm of a positive normal number, without call nor branch
+ *
+ * x = 2^e m with m in [sqrt(2)/2, sqrt(2)), and log(m) = 2 atanh(s), s = (m - 1)/(m + 1),
+ * by its series up to s^19: the relative error is below 1e-15. The exponent and the
+ * mantissa are read from the bits and the selections are made on the bits, so
+ * that a loop over this function is vectorized.
+ *
+ * @param x positive normal number
+ * @return double
+ */
+RANDOM_INLINE double vectorLog( double x )
+{
+    using namespace random_detail;
+    std::uint64_t bits = toBits( x );
+    // biased exponent, converted exactly through the mantissa of 2^52
+    double e = fromBits( ( bits >> 52 ) | 0x4330000000000000ull ) - 4503599627370496. - 1023;
+    double m = fromBits( ( bits & 0x000FFFFFFFFFFFFFull ) | 0x3FF0000000000000ull );
+    bool high = m > M_SQRT2;
+    m = blend( high, m / 2, m );
+    e = blend( high, e + 1, e );
+    double s = ( m - 1 ) / ( m + 1 ), s2 = s * s;
+    double series = 1 + s2*(1./3 + s2*(1./5 + s2*(1./7 + s2*(1./9 + s2*(1./11 + s2*(1./13 + s2*(1./15 + s2*(1./17 + s2/19))))))));
+    return e * M_LN2 + 2 * s * series;
+}
+
+/**
+ * @brief Exponential, without call nor branch
+ *
+ * x = k log(2) + r with |r| <= log(2)/2, and exp(x) = 2^k exp(r), exp(r) by its Taylor
+ * series up to r^13: the relative error is below 1e-15. k is rounded by the addition of
+ * 1.5 2^52 and 2^k is built from its bits, so that a loop over this function is vectorized.
+ *
+ * @param x argument, clamped to [-708, 709]
+ * @return double
+ */
+RANDOM_INLINE double vectorExp( double x )
+{
+    using namespace random_detail;
+    static constexpr double shifter = 6755399441055744.;        // 1.5 2^52
+    static constexpr double ln2_hi = 6.93147180369123816490e-01, ln2_lo = 1.90821492927058770002e-10;
+    x = blend( x < -708, -708, blend( x > 709, 709, x ) );
+    double t = x * M_LOG2E + shifter;
+    double k = t - shifter;
+    double r = ( x - k * ln2_hi ) - k * ln2_lo;
+    double p = 1 + r*(1 + r*(1./2 + r*(1./6 + r*(1./24 + r*(1./120 + r*(1./720 + r*(1./5040 + r*(1./40320
+        + r*(1./362880 + r*(1./3628800 + r*(1./39916800 + r*(1./479001600 + r/6227020800.))))))))))));
+    // k, in [-1021, 1023] after the clamp, is in the low bits of t, and 2^k is a normal number
+    return p * fromBits( ( toBits( t ) - toBits( shifter ) + 1023 ) << 52 );
+}
+
+/**
+ * @brief Square root of a positive normal number, without call
+ *
+ * std::sqrt may call the library to set errno on a negative argument, which
+ * stops the vectorization: the reciprocal square root is refined by four Newton
+ * iterations from an estimate read on the bits, which gives a relative error below 1e-15.
+ *
+ * @param x positive normal number
+ * @return double
+ */
+RANDOM_INLINE double vectorSqrt( double x )
+{
+    using namespace random_detail;
+    double y = fromBits( 0x5FE6EB50C7B537A9ull - ( toBits( x ) >> 1 ) );
+    for (int i = 0; i < 4; ++i)
+        y = y * ( 1.5 - 0.5 * x * y * y );
+    return x * y;
+}
+
+/**
+ * @brief Quantile of the standard normal distribution
+ *
+ * Rational approximation of Acklam, of relative error below 1.2e-9, which is
+ * far below the sampling error. Both the central and the tail approximations
+ * are computed and one of them is selected, without branch, with the logarithm
+ * vectorLog, so that a loop over this function is vectorized.
+ *
+ * @param p probability, in (0, 1)
+ * @return double
+ */
+RANDOM_INLINE double normalQuantile( double p )
+{
+    static constexpr double a[6] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                     1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static constexpr double b[5] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                     6.680131188771972e+01, -1.328068155288572e+01 };
+    static constexpr double c[6] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                     -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static constexpr double d[4] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                     3.754408661907416e+00 };
+    double q = p - 0.5, r = q * q;
+    double central = (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q
+        / (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+    double tail = random_detail::blend( p < 0.5, p, 1 - p );
+    double t = vectorSqrt( -2 * vectorLog( tail ) );
+    double lower = (((((c[0]*t + c[1])*t + c[2])*t + c[3])*t + c[4])*t + c[5])
+        / ((((d[0]*t + d[1])*t + d[2])*t + d[3])*t + 1);
+    return random_detail::blend( tail >= 0.02425, central, random_detail::blend( p < 0.5, lower, -lower ) );
+}
+
+/**
+ * @brief Cumulative distribution function of the standard normal distribution
+ */
+inline double normalCDF( double x )
+{
+    return 0.5 * std::erfc( -x * M_SQRT1_2 );
+}
+
+/**
+ * @brief Quantiles of a uniform distribution on [a, b], on a block of probabilities
+ *
+ * @param u probabilities
+ * @param n number of probabilities
+ * @param a lower bound
+ * @param b upper bound
+ * @param x quantiles, of size n
+ */
+inline void uniformQuantile( double const* u, size_t n, double a, double b, double* x )
+{
+    double w = b - a;
+#pragma omp simd
+    for (size_t k = 0; k < n; ++k)
+        x[k] = a + w * u[k];
+}
+
+namespace random_detail
+{
+// quantiles of the truncated log-normal distribution, pa = Phi(za) and w = Phi(zb) - Phi(za)
+RANDOM_INLINE void truncatedLogNormalLoop( double const* u, size_t n, double mu, double sigma, double gamma,
+                                           double a, double b, double pa, double w, double* x )
+{
+#pragma omp simd
+    for (size_t k = 0; k < n; ++k)
+    {
+        double y = gamma + vectorExp( mu + sigma * normalQuantile( pa + w * u[k] ) );
+        x[k] = blend( y < a, a, blend( y > b, b, y ) );
+    }
+}
+
+#if RANDOM_STREAMS_DISPATCH
+// the loop compiled for AVX2, whatever the flags of the target: without fma, so that
+// the operations, hence the draws, are the same as the ones of the default loop
+__attribute__((target("avx2")))
+inline void truncatedLogNormalAvx2( double const* u, size_t n, double mu, double sigma, double gamma,
+                                    double a, double b, double pa, double w, double* x )
+{
+    truncatedLogNormalLoop( u, n, mu, sigma, gamma, a, b, pa, w, x );
+}
+
+inline bool hasAvx2()
+{
+    static bool const has = ( __builtin_cpu_init(), __builtin_cpu_supports( "avx2" ) );
+    return has;
+}
+#endif
+} // namespace random_detail
+
+/**
+ * @brief Quantiles of a log-normal distribution truncated to [a, b], on a block of probabilities
+ *
+ * The log-normal variable is gamma + exp(mu + sigma N), N being standard normal,
+ * so that the quantile of u is gamma + exp(mu + sigma Phi^-1(Phi(za) + u (Phi(zb) - Phi(za)))),
+ * za and zb being the standardized bounds.
+ * The loop is vectorized, and compiled for AVX2 as well, used when the processor supports it.
+ *
+ * @param u probabilities
+ * @param n number of probabilities
+ * @param mu mean of the logarithm
+ * @param sigma standard deviation of the logarithm
+ * @param gamma location
+ * @param a lower bound of the truncation, not less than gamma
+ * @param b upper bound of the truncation
+ * @param x quantiles, of size n
+ */
+inline void truncatedLogNormalQuantile( double const* u, size_t n, double mu, double sigma, double gamma,
+                                        double a, double b, double* x )
+{
+    double pa = a > gamma ? normalCDF( ( std::log( a - gamma ) - mu ) / sigma ) : 0;
+    double pb = normalCDF( ( std::log( b - gamma ) - mu ) / sigma );
+#if RANDOM_STREAMS_DISPATCH
+    if ( random_detail::hasAvx2() )
+        return random_detail::truncatedLogNormalAvx2( u, n, mu, sigma, gamma, a, b, pa, pb - pa, x );
+#endif
+    random_detail::truncatedLogNormalLoop( u, n, mu, sigma, gamma, a, b, pa, pb - pa, x );
+}
+
+#endif // __RANDOM_STREAMS_HPP__
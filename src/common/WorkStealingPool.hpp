@@ -0,0 +1,188 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file WorkStealingPool.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Pool of worker threads balancing tasks of uneven costs by work stealing
+//!
+
+#ifndef __WORK_STEALING_POOL_HPP__
+#define __WORK_STEALING_POOL_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief Tasks run by a fixed number of workers, each one owning a deque of tasks
+ *
+ * A worker takes its own tasks from the back of its deque, most recently pushed
+ * first, and once its deque is empty steals the oldest task of another worker,
+ * from the front of its deque. A task may push new tasks, on the deque of the
+ * worker running it, so that a task found to be more costly than expected is
+ * continued by the first idle worker instead of delaying the others.
+ * The pool runs until all the tasks, including the pushed ones, are done.
+ */
+template <typename Task>
+class WorkStealingPool
+{
+public:
+    /**
+     * @brief Construct a new WorkStealingPool object
+     *
+     * @param nthreads number of workers, the calling thread of run being worker 0
+     */
+    explicit WorkStealingPool( size_t nthreads ) :
+        M_queues( std::max<size_t>( nthreads, 1 ) ), M_pending(0)
+    {
+        for ( auto& queue : M_queues )
+            queue = std::make_unique<Queue>();
+    }
+
+    size_t nThreads() const { return M_queues.size(); };
+
+    /**
+     * @brief Add a task to the deque of a worker, before run or from a task running on this worker
+     *
+     * @param worker worker owning the task
+     * @param task task to add
+     */
+    void push( size_t worker, Task task )
+    {
+        M_pending.fetch_add( 1, std::memory_order_relaxed );
+        Queue& queue = *M_queues[worker % M_queues.size()];
+        std::lock_guard<std::mutex> lock( queue.mutex );
+        queue.tasks.push_back( std::move( task ) );
+    }
+
+    /**
+     * @brief Run f( worker, task ) on all the tasks until none is left
+     *
+     * The first exception thrown by a task drops the remaining tasks and is
+     * rethrown once all threads are joined.
+     *
+     * @param f function called on each task, which may push new tasks
+     */
+    template <typename Function>
+    void run( Function&& f )
+    {
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto work = [&]( size_t worker )
+        {
+            // a task is counted as pending until it is done, so that the tasks it pushes are counted before it ends
+            while ( M_pending.load( std::memory_order_acquire ) > 0 )
+            {
+                std::optional<Task> task = pop( worker );
+                if ( !task )
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                try
+                {
+                    f( worker, *task );
+                }
+                catch ( ... )
+                {
+                    {
+                        std::lock_guard<std::mutex> lock( error_mutex );
+                        if ( !error )
+                            error = std::current_exception();
+                    }
+                    clear();
+                }
+                M_pending.fetch_sub( 1, std::memory_order_acq_rel );
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve( M_queues.size() - 1 );
+        for ( size_t w = 1; w < M_queues.size(); ++w )
+            threads.emplace_back( work, w );
+        work( 0 );
+        for ( auto& t : threads )
+            t.join();
+        if ( error )
+            std::rethrow_exception( error );
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /**
+     * @brief Take the last task of the worker, or else steal the first task of another worker
+     */
+    std::optional<Task> pop( size_t worker )
+    {
+        {
+            Queue& own = *M_queues[worker];
+            std::lock_guard<std::mutex> lock( own.mutex );
+            if ( !own.tasks.empty() )
+            {
+                std::optional<Task> task( std::move( own.tasks.back() ) );
+                own.tasks.pop_back();
+                return task;
+            }
+        }
+        for ( size_t k = 1; k < M_queues.size(); ++k )
+        {
+            Queue& victim = *M_queues[( worker + k ) % M_queues.size()];
+            std::lock_guard<std::mutex> lock( victim.mutex );
+            if ( !victim.tasks.empty() )
+            {
+                std::optional<Task> task( std::move( victim.tasks.front() ) );
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Drop the tasks not started yet
+     */
+    void clear()
+    {
+        for ( auto& queue : M_queues )
+        {
+            std::lock_guard<std::mutex> lock( queue->mutex );
+            M_pending.fetch_sub( queue->tasks.size(), std::memory_order_acq_rel );
+            queue->tasks.clear();
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> M_queues;
+    std::atomic<size_t> M_pending;      // tasks pushed and not done yet
+};
+
+
+#endif // __WORK_STEALING_POOL_HPP__
@@ -0,0 +1,337 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file ChaosBatchKernel.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Vectorized evaluation of a polynomial chaos metamodel on many points at once
+//!
+//! The instruction set is chosen at run time: with GCC or Clang on x86-64, the
+//! blocks are evaluated with AVX-512 or AVX2 when the processor supports them,
+//! whatever the flags the code is compiled with, and with a scalar loop otherwise.
+//!
+
+#ifndef __CHAOS_BATCH_KERNEL_HPP__
+#define __CHAOS_BATCH_KERNEL_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ChaosMetamodel.hpp"
+
+#if ( defined(__GNUC__) || defined(__clang__) ) && defined(__x86_64__)
+#define CHAOS_BATCH_DISPATCH 1
+#define CHAOS_INLINE inline __attribute__((always_inline))
+#else
+#define CHAOS_BATCH_DISPATCH 0
+#define CHAOS_INLINE inline
+#endif
+
+
+namespace chaos_detail
+{
+/**
+ * @brief Single double, for the scalar loop
+ */
+struct ScalarPack
+{
+    static constexpr size_t width = 1;
+    double v;
+
+    static CHAOS_INLINE ScalarPack load( double const* p ) { return { *p }; }
+    static CHAOS_INLINE ScalarPack set1( double a ) { return { a }; }
+    CHAOS_INLINE void store( double* p ) const { *p = v; }
+    friend CHAOS_INLINE ScalarPack operator+( ScalarPack a, ScalarPack b ) { return { a.v + b.v }; }
+    friend CHAOS_INLINE ScalarPack operator-( ScalarPack a, ScalarPack b ) { return { a.v - b.v }; }
+    friend CHAOS_INLINE ScalarPack operator*( ScalarPack a, ScalarPack b ) { return { a.v * b.v }; }
+    friend CHAOS_INLINE ScalarPack fma( ScalarPack a, ScalarPack b, ScalarPack c ) { return { a.v * b.v + c.v }; }
+};
+
+#if CHAOS_BATCH_DISPATCH
+/**
+ * @brief W doubles in a vector of the GCC and Clang vector extension
+ *
+ * The operations carry no instruction set of their own: once inlined in a
+ * function compiled for AVX2 or AVX-512, they use its registers and instructions.
+ */
+template <size_t W>
+struct VectorPack
+{
+    typedef double vector_t __attribute__((vector_size( W * sizeof(double) )));
+    static constexpr size_t width = W;
+    vector_t v;
+
+    static CHAOS_INLINE VectorPack load( double const* p ) { VectorPack r; std::memcpy( &r.v, p, sizeof r.v ); return r; }
+    static CHAOS_INLINE VectorPack set1( double a ) { VectorPack r; r.v = vector_t{} + a; return r; }
+    CHAOS_INLINE void store( double* p ) const { std::memcpy( p, &v, sizeof v ); }
+    friend CHAOS_INLINE VectorPack operator+( VectorPack const& a, VectorPack const& b ) { return { a.v + b.v }; }
+    friend CHAOS_INLINE VectorPack operator-( VectorPack const& a, VectorPack const& b ) { return { a.v - b.v }; }
+    friend CHAOS_INLINE VectorPack operator*( VectorPack const& a, VectorPack const& b ) { return { a.v * b.v }; }
+    // contracted to a fused multiply-add by the compiler, the functions using it being compiled with FMA
+    friend CHAOS_INLINE VectorPack fma( VectorPack const& a, VectorPack const& b, VectorPack const& c ) { return { a.v * b.v + c.v }; }
+};
+#endif
+} // namespace chaos_detail
+
+
+/**
+ * @brief Batch evaluator of a ChaosMetamodel, the points being processed by blocks in structure-of-arrays layout
+ *
+ * For each block of points, the univariate polynomials of each input are computed
+ * by their recurrence, one row of the block per degree, then each term of the chaos
+ * is accumulated as the product of the rows of its non zero degrees.
+ * The kernel is stateless once built, and can be shared by several threads.
+ */
+class ChaosBatchKernel
+{
+public:
+    static constexpr size_t block = 64;     // number of points of a block, multiple of the widths of the packs
+
+    /**
+     * @brief Instruction sets supported by the processor, the best one first
+     *
+     * @return std::vector<std::string> among avx512, avx2 and scalar
+     */
+    static std::vector<std::string> availableInstructionSets()
+    {
+        std::vector<std::string> sets;
+#if CHAOS_BATCH_DISPATCH
+        __builtin_cpu_init();
+        if ( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "fma" ) )
+            sets.push_back( "avx512" );
+        if ( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) )
+            sets.push_back( "avx2" );
+#endif
+        sets.push_back( "scalar" );
+        return sets;
+    }
+
+    /**
+     * @brief Construct a new ChaosBatchKernel object
+     *
+     * @param metamodel metamodel to evaluate
+     * @param instruction_set avx512, avx2 or scalar, empty for the best one supported by the processor
+     */
+    explicit ChaosBatchKernel( ChaosMetamodel const& metamodel, std::string const& instruction_set = "" ) :
+        M_dim( metamodel.dimension() )
+    {
+        std::vector<std::string> sets = availableInstructionSets();
+        M_instructionSet = instruction_set.empty() ? sets.front() : instruction_set;
+        if ( std::find( sets.begin(), sets.end(), M_instructionSet ) == sets.end() )
+            throw std::invalid_argument( "ChaosBatchKernel: instruction set " + M_instructionSet + " not supported" );
+        M_evaluateBlock = &ChaosBatchKernel::evaluateBlockScalar;
+#if CHAOS_BATCH_DISPATCH
+        if ( M_instructionSet == "avx512" )
+            M_evaluateBlock = &ChaosBatchKernel::evaluateBlockAvx512;
+        else if ( M_instructionSet == "avx2" )
+            M_evaluateBlock = &ChaosBatchKernel::evaluateBlockAvx2;
+#endif
+
+        // the value of P^j_k is the row M_inputs[j].row + k of the buffer of a block
+        size_t rows = 0;
+        for (size_t j = 0; j < M_dim; ++j)
+        {
+            size_t degree = 0;
+            for (size_t t = 0; t < metamodel.size(); ++t)
+                degree = std::max<size_t>( degree, metamodel.multiIndex( t, j ) );
+            ChaosMetamodel::Marginal const& m = metamodel.marginals()[j];
+            M_inputs.push_back( { m.shift, 1. / m.scale, degree, rows,
+                                  std::vector<double>( m.recurrence.begin(), m.recurrence.begin() + 3*degree ) } );
+            rows += degree + 1;
+        }
+        M_rows = rows;
+
+        // the factors of degree 0 are 1 and are dropped
+        M_termStart.push_back( 0 );
+        for (size_t t = 0; t < metamodel.size(); ++t)
+        {
+            for (size_t j = 0; j < M_dim; ++j)
+                if ( std::uint32_t k = metamodel.multiIndex( t, j ) )
+                    M_factors.push_back( std::uint32_t( M_inputs[j].row + k ) );
+            M_termStart.push_back( M_factors.size() );
+            M_coefficients.push_back( metamodel.coefficients()[t] );
+        }
+    }
+
+    size_t dimension() const { return M_dim; };
+
+    /**
+     * @brief Instruction set used by the kernel : avx512, avx2 or scalar
+     */
+    std::string const& instructionSet() const { return M_instructionSet; }
+
+    /**
+     * @brief Evaluate the metamodel at n points in structure-of-arrays layout
+     *
+     * @param X values of the inputs, the input j of the point i being X[j*ld + i]
+     * @param ld leading dimension of X, at least n
+     * @param n number of points
+     * @param Y values, of size n
+     */
+    void evaluate( double const* X, size_t ld, size_t n, double* Y ) const
+    {
+        std::vector<double> buffer( ( M_rows + M_dim + 1 ) * block );
+        double* x = buffer.data() + M_rows * block;
+        double* y = x + M_dim * block;
+        for (size_t begin = 0; begin < n; begin += block)
+        {
+            size_t m = std::min( block, n - begin );
+            if ( m == block )
+            {
+                evaluateBlock( X + begin, ld, buffer.data(), Y + begin );
+                continue;
+            }
+            // last block, padded with its first point
+            for (size_t j = 0; j < M_dim; ++j)
+            {
+                std::copy( X + j*ld + begin, X + j*ld + begin + m, x + j*block );
+                std::fill( x + j*block + m, x + ( j + 1 )*block, X[j*ld + begin] );
+            }
+            evaluateBlock( x, block, buffer.data(), y );
+            std::copy( y, y + m, Y + begin );
+        }
+    }
+
+    /**
+     * @brief Evaluate the metamodel at n points in row-major layout, as the data of an OT::Sample
+     *
+     * @param X points, the input j of the point i being X[i*dimension + j]
+     * @param n number of points
+     * @param Y values, of size n
+     */
+    void evaluateRows( double const* X, size_t n, double* Y ) const
+    {
+        std::vector<double> buffer( ( M_rows + M_dim + 1 ) * block );
+        double* x = buffer.data() + M_rows * block;
+        double* y = x + M_dim * block;
+        for (size_t begin = 0; begin < n; begin += block)
+        {
+            size_t m = std::min( block, n - begin );
+            for (size_t i = 0; i < block; ++i)
+            {
+                double const* point = X + ( begin + std::min( i, m - 1 ) ) * M_dim;
+                for (size_t j = 0; j < M_dim; ++j)
+                    x[j*block + i] = point[j];
+            }
+            evaluateBlock( x, block, buffer.data(), y );
+            std::copy( y, y + m, Y + begin );
+        }
+    }
+
+private:
+    struct Input
+    {
+        double shift;
+        double inverseScale;
+        size_t degree;
+        size_t row;                     // row of P_0 in the buffer of a block
+        std::vector<double> recurrence; // (a_k, b_k, c_k) for k < degree
+    };
+
+    using evaluate_block_t = void (ChaosBatchKernel::*)( double const*, size_t, double*, double* ) const;
+
+    /**
+     * @brief Evaluate a full block of points with the instruction set of the kernel
+     *
+     * @param X values of the inputs of the block, the input j of the point i being X[j*ld + i]
+     * @param ld leading dimension of X
+     * @param P buffer of M_rows * block values of the univariate polynomials
+     * @param Y values, of size block
+     */
+    void evaluateBlock( double const* X, size_t ld, double* P, double* Y ) const
+    {
+        ( this->*M_evaluateBlock )( X, ld, P, Y );
+    }
+
+    void evaluateBlockScalar( double const* X, size_t ld, double* P, double* Y ) const
+    {
+        evaluateBlockWith<chaos_detail::ScalarPack>( X, ld, P, Y );
+    }
+
+#if CHAOS_BATCH_DISPATCH
+    __attribute__((target("avx512f,fma")))
+    void evaluateBlockAvx512( double const* X, size_t ld, double* P, double* Y ) const
+    {
+        evaluateBlockWith<chaos_detail::VectorPack<8>>( X, ld, P, Y );
+    }
+
+    __attribute__((target("avx2,fma")))
+    void evaluateBlockAvx2( double const* X, size_t ld, double* P, double* Y ) const
+    {
+        evaluateBlockWith<chaos_detail::VectorPack<4>>( X, ld, P, Y );
+    }
+#endif
+
+    /**
+     * @brief Evaluate a full block of points with packs of Pack::width points, inlined in the function of an instruction set
+     */
+    template <typename Pack>
+    CHAOS_INLINE void evaluateBlockWith( double const* X, size_t ld, double* P, double* Y ) const
+    {
+        for ( Input const& input : M_inputs )
+        {
+            double const* x = X + ( &input - M_inputs.data() ) * ld;
+            double* p = P + input.row * block;
+            Pack shift = Pack::set1( input.shift ), inverseScale = Pack::set1( input.inverseScale );
+            for (size_t i = 0; i < block; i += Pack::width)
+            {
+                Pack z = ( Pack::load( x + i ) - shift ) * inverseScale;
+                Pack previous = Pack::set1( 0 ), current = Pack::set1( 1 );
+                current.store( p + i );
+                for (size_t k = 0; k < input.degree; ++k)
+                {
+                    double const* abc = input.recurrence.data() + 3*k;
+                    Pack next = fma( fma( Pack::set1( abc[0] ), z, Pack::set1( abc[1] ) ), current, Pack::set1( abc[2] ) * previous );
+                    next.store( p + ( k + 1 ) * block + i );
+                    previous = current;
+                    current = next;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < block; i += Pack::width)
+        {
+            Pack y = Pack::set1( 0 );
+            for (size_t t = 0; t < M_coefficients.size(); ++t)
+            {
+                Pack term = Pack::set1( M_coefficients[t] );
+                for (size_t f = M_termStart[t]; f < M_termStart[t + 1]; ++f)
+                    term = term * Pack::load( P + M_factors[f] * block + i );
+                y = y + term;
+            }
+            y.store( Y + i );
+        }
+    }
+
+    size_t M_dim;
+    std::string M_instructionSet;
+    evaluate_block_t M_evaluateBlock;
+    size_t M_rows;                          // number of rows of univariate polynomials of a block
+    std::vector<Input> M_inputs;
+    std::vector<size_t> M_termStart;        // factors of the term t are M_factors[M_termStart[t]:M_termStart[t+1]]
+    std::vector<std::uint32_t> M_factors;   // rows of the univariate polynomials of non zero degree of each term
+    std::vector<double> M_coefficients;
+};
+
+
+#endif // __CHAOS_BATCH_KERNEL_HPP__
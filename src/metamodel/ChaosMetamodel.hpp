@@ -0,0 +1,316 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file ChaosMetamodel.hpp
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Standalone polynomial chaos metamodel : binary artefact, evaluator and C++ code generator
+//!
+//! This header only depends on the standard library, so that the metamodels
+//! exported by the sensitivity analysis can be evaluated without Feel++,
+//! the CRB database or OpenTURNS.
+//!
+
+#ifndef __CHAOS_METAMODEL_HPP__
+#define __CHAOS_METAMODEL_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Polynomial chaos y(x) = sum_t c_t prod_j P^j_{alpha_tj}(z_j), z_j = (x_j - shift_j) / scale_j
+ *
+ * The univariate polynomials are orthonormal, defined by their three-term recurrence
+ *   P_0 = 1, P_{-1} = 0, P_{k+1}(z) = (a_k z + b_k) P_k(z) + c_k P_{k-1}(z),
+ * which is the convention of OT::OrthogonalUniVariatePolynomialFamily.
+ *
+ * Binary artefact (little endian) :
+ *   - magic "FPPCHAOS", uint32 version,
+ *   - uint32 dimension d, uint32 number of terms T,
+ *   - for each input j : double shift, double scale, uint32 degree D_j, D_j * (a, b, c) doubles,
+ *   - T * d uint32 multi-indices, row by row,
+ *   - T double coefficients.
+ */
+class ChaosMetamodel
+{
+public:
+    static constexpr char magic[9] = "FPPCHAOS";
+    static constexpr std::uint32_t version = 1;
+
+    /**
+     * @brief Transform and polynomial family of an input
+     */
+    struct Marginal
+    {
+        double shift = 0;
+        double scale = 1;
+        std::vector<double> recurrence;     // (a_k, b_k, c_k) for k < degree
+
+        size_t degree() const { return recurrence.size() / 3; };
+    };
+
+    ChaosMetamodel() = default;
+
+    /**
+     * @brief Construct a new ChaosMetamodel object
+     *
+     * @param marginals transform and recurrence of each input, up to the maximal degree of the terms
+     * @param multiIndices multi-index of each term, of size dimension
+     * @param coefficients coefficient of each term
+     */
+    ChaosMetamodel( std::vector<Marginal> const& marginals, std::vector<std::vector<std::uint32_t>> const& multiIndices,
+                    std::vector<double> const& coefficients ) :
+        M_marginals(marginals), M_coefficients(coefficients)
+    {
+        if ( multiIndices.size() != coefficients.size() )
+            throw std::invalid_argument( "ChaosMetamodel: one coefficient per term is expected" );
+        M_multiIndices.reserve( multiIndices.size() * dimension() );
+        for ( auto const& alpha : multiIndices )
+        {
+            if ( alpha.size() != dimension() )
+                throw std::invalid_argument( "ChaosMetamodel: multi-index of a wrong dimension" );
+            M_multiIndices.insert( M_multiIndices.end(), alpha.begin(), alpha.end() );
+        }
+        check();
+    }
+
+    // Accessors
+    size_t dimension() const { return M_marginals.size(); };
+    size_t size() const { return M_coefficients.size(); };
+    std::vector<Marginal> const& marginals() const { return M_marginals; };
+    std::vector<double> const& coefficients() const { return M_coefficients; };
+    std::uint32_t multiIndex( size_t t, size_t j ) const { return M_multiIndices[t*dimension() + j]; };
+
+    /**
+     * @brief Evaluate the metamodel at a point
+     *
+     * @param x point, of size dimension
+     * @return double
+     */
+    double evaluate( double const* x ) const
+    {
+        std::vector<double> P;
+        return evaluate( x, P );
+    }
+
+    /**
+     * @brief Evaluate the metamodel at n points
+     *
+     * @param X row-major points, of size n * dimension
+     * @param n number of points
+     * @param Y values, of size n
+     */
+    void evaluate( double const* X, size_t n, double* Y ) const
+    {
+        std::vector<double> P;
+        for (size_t i = 0; i < n; ++i)
+            Y[i] = evaluate( X + i*dimension(), P );
+    }
+
+    /**
+     * @brief Write the binary artefact
+     *
+     * @param path path of the file
+     */
+    void save( std::string const& path ) const
+    {
+        std::ofstream out( path, std::ios::binary );
+        out.write( magic, 8 );
+        write( out, version );
+        write( out, std::uint32_t( dimension() ) );
+        write( out, std::uint32_t( size() ) );
+        for ( auto const& m : M_marginals )
+        {
+            write( out, m.shift );
+            write( out, m.scale );
+            write( out, std::uint32_t( m.degree() ) );
+            out.write( reinterpret_cast<char const*>( m.recurrence.data() ), m.recurrence.size() * sizeof(double) );
+        }
+        out.write( reinterpret_cast<char const*>( M_multiIndices.data() ), M_multiIndices.size() * sizeof(std::uint32_t) );
+        out.write( reinterpret_cast<char const*>( M_coefficients.data() ), M_coefficients.size() * sizeof(double) );
+        if ( !out )
+            throw std::runtime_error( "ChaosMetamodel: failed to write " + path );
+    }
+
+    /**
+     * @brief Read a binary artefact written by save
+     *
+     * @param path path of the file
+     * @return ChaosMetamodel
+     */
+    static ChaosMetamodel load( std::string const& path )
+    {
+        std::ifstream in( path, std::ios::binary );
+        char header[8];
+        in.read( header, 8 );
+        if ( !in || std::memcmp( header, magic, 8 ) != 0 )
+            throw std::runtime_error( "ChaosMetamodel: " + path + " is not a chaos metamodel" );
+        if ( read<std::uint32_t>( in ) != version )
+            throw std::runtime_error( "ChaosMetamodel: unsupported version of " + path );
+
+        ChaosMetamodel m;
+        size_t dim = read<std::uint32_t>( in ), T = read<std::uint32_t>( in );
+        m.M_marginals.resize( dim );
+        for ( auto& marginal : m.M_marginals )
+        {
+            marginal.shift = read<double>( in );
+            marginal.scale = read<double>( in );
+            marginal.recurrence.resize( 3 * read<std::uint32_t>( in ) );
+            in.read( reinterpret_cast<char*>( marginal.recurrence.data() ), marginal.recurrence.size() * sizeof(double) );
+        }
+        m.M_multiIndices.resize( T * dim );
+        m.M_coefficients.resize( T );
+        in.read( reinterpret_cast<char*>( m.M_multiIndices.data() ), m.M_multiIndices.size() * sizeof(std::uint32_t) );
+        in.read( reinterpret_cast<char*>( m.M_coefficients.data() ), m.M_coefficients.size() * sizeof(double) );
+        if ( !in )
+            throw std::runtime_error( "ChaosMetamodel: " + path + " is truncated" );
+        m.check();
+        return m;
+    }
+
+    /**
+     * @brief Generate the C++ code of a function evaluating the metamodel
+     *
+     * The recurrences are unrolled with the coefficients as literals, so that
+     * the generated function has no loop nor memory access besides x.
+     *
+     * @param name name of the generated function
+     * @return std::string code of `inline double name( double const* x )`
+     */
+    std::string generateCode( std::string const& name ) const
+    {
+        std::ostringstream code;
+        code << std::setprecision( 17 );
+        code << "// Polynomial chaos metamodel generated by ChaosMetamodel::generateCode\n";
+        code << "// " << dimension() << " input(s), " << size() << " term(s)\n";
+        code << "inline double " << name << "( double const* x )\n{\n";
+        for (size_t j = 0; j < dimension(); ++j)
+        {
+            Marginal const& m = M_marginals[j];
+            size_t degree = maxDegree( j );
+            if ( degree == 0 )
+                continue;
+            code << "    const double z" << j << " = ( x[" << j << "] - " << m.shift << " ) / " << m.scale << ";\n";
+            code << "    const double p" << j << "_0 = 1.;\n";
+            for (size_t k = 0; k < degree; ++k)
+            {
+                double a = m.recurrence[3*k], b = m.recurrence[3*k + 1], c = m.recurrence[3*k + 2];
+                code << "    const double p" << j << "_" << k + 1 << " = ( " << a << " * z" << j << " + " << b << " ) * p" << j << "_" << k;
+                if ( k > 0 )
+                    code << " + " << c << " * p" << j << "_" << k - 1;
+                code << ";\n";
+            }
+        }
+        code << "    return 0.";
+        for (size_t t = 0; t < size(); ++t)
+        {
+            code << "\n        + " << M_coefficients[t];
+            for (size_t j = 0; j < dimension(); ++j)
+                if ( multiIndex( t, j ) > 0 )
+                    code << " * p" << j << "_" << multiIndex( t, j );
+        }
+        code << ";\n}\n";
+        return code.str();
+    }
+
+private:
+    /**
+     * @brief Evaluate at a point, P being a buffer for the values of the univariate polynomials
+     */
+    double evaluate( double const* x, std::vector<double>& P ) const
+    {
+        size_t dim = dimension();
+        P.resize( M_offsets.back() );
+        for (size_t j = 0; j < dim; ++j)
+        {
+            Marginal const& m = M_marginals[j];
+            double z = ( x[j] - m.shift ) / m.scale;
+            double* p = P.data() + M_offsets[j];
+            size_t degree = M_offsets[j + 1] - M_offsets[j] - 1;
+            p[0] = 1;
+            double previous = 0;
+            for (size_t k = 0; k < degree; ++k)
+            {
+                p[k + 1] = ( m.recurrence[3*k] * z + m.recurrence[3*k + 1] ) * p[k] + m.recurrence[3*k + 2] * previous;
+                previous = p[k];
+            }
+        }
+
+        double y = 0;
+        for (size_t t = 0; t < size(); ++t)
+        {
+            double term = M_coefficients[t];
+            std::uint32_t const* alpha = M_multiIndices.data() + t*dim;
+            for (size_t j = 0; j < dim; ++j)
+                term *= P[M_offsets[j] + alpha[j]];
+            y += term;
+        }
+        return y;
+    }
+
+    size_t maxDegree( size_t j ) const
+    {
+        size_t degree = 0;
+        for (size_t t = 0; t < size(); ++t)
+            degree = std::max<size_t>( degree, multiIndex( t, j ) );
+        return degree;
+    }
+
+    /**
+     * @brief Check that the recurrences reach the degrees of the terms, and set the offsets of the buffer
+     */
+    void check()
+    {
+        M_offsets.assign( 1, 0 );
+        for (size_t j = 0; j < dimension(); ++j)
+        {
+            size_t degree = maxDegree( j );
+            if ( M_marginals[j].degree() < degree )
+                throw std::invalid_argument( "ChaosMetamodel: the recurrence of the input " + std::to_string(j) + " is too short" );
+            M_offsets.push_back( M_offsets.back() + degree + 1 );
+        }
+    }
+
+    template <typename T>
+    static void write( std::ostream& out, T v ) { out.write( reinterpret_cast<char const*>( &v ), sizeof(T) ); }
+
+    template <typename T>
+    static T read( std::istream& in )
+    {
+        T v;
+        in.read( reinterpret_cast<char*>( &v ), sizeof(T) );
+        return v;
+    }
+
+    std::vector<Marginal> M_marginals;
+    std::vector<std::uint32_t> M_multiIndices;
+    std::vector<double> M_coefficients;
+    std::vector<size_t> M_offsets;      // offset of the values of the polynomials of each input in the buffer
+};
+
+
+#endif // __CHAOS_METAMODEL_HPP__
@@ -0,0 +1,146 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Count the heap allocations per evaluation of the online code
+//!
+//! Usage: feelpp_mor_test_evaluation_engine --crbmodel.name <model-name> [--sampling.size <n>]
+//! The last modified database of the model is used.
+//!
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <openturns/OT.hxx>
+
+#include <feel/feelmor/options.hpp>
+#include <feel/feelmor/crbplugin_interface.hpp>
+#include <feel/feelmor/crbmodeldb.hpp>
+
+#include "../../src/SA/EvaluationEngine.hpp"
+
+typedef Feel::ParameterSpaceX::element_type element_t;
+
+static std::atomic<size_t> allocations{0};
+
+void* operator new( std::size_t size )
+{
+    ++allocations;
+    if ( void* p = std::malloc( size ? size : 1 ) )
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, std::size_t ) noexcept { std::free( p ); }
+
+
+inline Feel::AboutData makeAbout()
+{
+    Feel::AboutData about( "test_evaluation_engine",
+                     "test_evaluation_engine" ,
+                     "0.1",
+                     "Allocations per evaluation of the online code",
+                     Feel::AboutData::License_GPL,
+                     "Copyright (c) 2026 Feel++ Consortium" );
+
+    about.addAuthor( "Thomas Saigre", "developer", "saigre@math.unistra.fr", "" );
+    return about;
+}
+
+/**
+ * @brief Run f on n evaluations and print the number of allocations per evaluation
+ */
+template <typename Function>
+double countAllocations( std::string const& name, size_t n, Function&& f )
+{
+    size_t before = allocations;
+    f();
+    double perEvaluation = double( allocations - before ) / n;
+    Feel::cout << name << ": " << perEvaluation << " allocation(s) per evaluation" << std::endl;
+    return perEvaluation;
+}
+
+int main( int argc, char** argv )
+{
+    using namespace Feel;
+    po::options_description options( "options" );
+    options.add_options()
+        ( "crbmodel.name", po::value<std::string>(), "CRB online code name" )
+        ( "crbmodel.db.load", po::value<std::string>()->default_value( "rb" ), "load rb, fe or all (fe and rb)" )
+        ( "crbmodel.db.root_directory", po::value<std::string>()->default_value( "${repository}/crbdb" ), "root directory of the CRB database " )
+        ( "sampling.size", po::value<int>()->default_value( 1000 ), "number of evaluations" )
+        ;
+
+    Environment env( _argc = argc, _argv = argv,
+                     _desc = options,
+                     _desc_lib = crbOptions().add( feel_options() ),
+                     _about = makeAbout() );
+
+    CRBModelDB crbmodelDB{ Environment::expand( soption(_name="crbmodel.name") ), uuids::nil_uuid() };
+    auto meta = crbmodelDB.loadDBMetaData( "last_modified", "modified" );
+    std::shared_ptr<CRBPluginAPI> plugin = crbmodelDB.loadDBPlugin( meta, soption(_name="crbmodel.db.load") );
+
+    auto Dmu = plugin->parameterSpace();
+    size_t dim = Dmu->dimension();
+    size_t n = ioption(_name="sampling.size");
+    double online_tol = 1e-2;
+    int rbDim = -1;
+
+    OT::Collection<OT::Distribution> marginals( dim );
+    for (size_t d = 0; d < dim; ++d)
+        marginals[d] = OT::Uniform( Dmu->min()(d), Dmu->max()(d) );
+    OT::Sample input = OT::ComposedDistribution( marginals ).getSample( n );
+    OT::Sample output( n, 1 );
+
+    // per-sample kernel used before the evaluation engine
+    countAllocations( "previous kernel", n, [&]() {
+        Eigen::VectorXd time_crb;
+        for (size_t i = 0; i < n; ++i)
+        {
+            element_t mu = Dmu->element();
+            OT::Point X = input[i];
+            for (size_t j = 0; j < dim; ++j)
+                mu.setParameter(j, X[j]);
+            CRBResults crbResult = plugin->run( mu, time_crb, online_tol, rbDim, false );
+            output[i] = OT::Point({ boost::get<0>( crbResult )[0] });
+        }
+    } );
+
+    // allocations done by the online code itself, out of reach of the caller
+    element_t mu = Dmu->element();
+    Eigen::VectorXd time_crb;
+    double online = countAllocations( "online code only", n, [&]() {
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t j = 0; j < dim; ++j)
+                mu.setParameter(j, input(i, j));
+            CRBResults crbResult = plugin->run( mu, time_crb, online_tol, rbDim, false );
+        }
+    } );
+
+    EvaluationEngine engine( plugin, online_tol, rbDim );
+    engine.evaluate( input.data(), 1, &output(0, 0), nullptr );
+    double engineAllocations = countAllocations( "evaluation engine", n, [&]() {
+        engine.evaluate( input.data(), n, &output(0, 0), nullptr );
+    } );
+
+    Feel::cout << "allocations of the engine on top of the online code: " << engineAllocations - online << std::endl;
+    return engineAllocations > online ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Check the standalone chaos metamodel, its batch kernel and its generated code on a chaos of orthonormal Legendre polynomials
+//!
+//! Usage: feelpp_mor_test_metamodel
+//!
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ChaosBatchKernel.hpp>
+
+
+/**
+ * @brief Recurrence of the Legendre polynomials orthonormal for the uniform measure on [-1, 1]
+ */
+ChaosMetamodel::Marginal legendre( double a, double b, size_t degree )
+{
+    ChaosMetamodel::Marginal m;
+    m.shift = ( a + b ) / 2;
+    m.scale = ( b - a ) / 2;
+    for (size_t n = 0; n < degree; ++n)
+    {
+        double alpha = std::sqrt( ( 2.*n + 1 ) * ( 2.*n + 3 ) ) / ( n + 1 );
+        double gamma = n == 0 ? 0 : -( n / ( n + 1. ) ) * std::sqrt( ( 2.*n + 3 ) / ( 2.*n - 1 ) );
+        m.recurrence.insert( m.recurrence.end(), { alpha, 0., gamma } );
+    }
+    return m;
+}
+
+/**
+ * @brief Values of the generated code at points, compiled with a main printing them
+ *
+ * @param code code defining chaos_metamodel, from ChaosMetamodel::generateCode
+ * @param X row-major points
+ * @param n number of points
+ * @param dim dimension of the points
+ * @return std::vector<double> values at the points, empty if the code does not compile
+ */
+std::vector<double> generatedValues( std::string const& code, double const* X, size_t n, size_t dim )
+{
+    std::string source = "test_metamodel_code.cpp", binary = "./test_metamodel_code";
+    {
+        std::ofstream out( source );
+        out << std::setprecision( 17 ) << code << "\n#include <cstdio>\n\nint main()\n{\n    static const double X[] = {";
+        for (size_t i = 0; i < n*dim; ++i)
+            out << ( i > 0 ? ", " : " " ) << X[i];
+        out << " };\n    for (unsigned i = 0; i < " << n << "; ++i)\n"
+            << "        std::printf( \"%.17g\\n\", chaos_metamodel( X + " << dim << "*i ) );\n    return 0;\n}\n";
+    }
+    std::vector<double> Y;
+    std::string command = std::string( METAMODEL_CXX_COMPILER ) + " -o " + binary + " " + source;
+    if ( std::system( command.c_str() ) == 0 )
+    {
+        if ( FILE* in = popen( binary.c_str(), "r" ) )
+        {
+            double y;
+            while ( std::fscanf( in, "%lf", &y ) == 1 )
+                Y.push_back( y );
+            pclose( in );
+        }
+        std::remove( binary.c_str() );
+    }
+    std::remove( source.c_str() );
+    return Y;
+}
+
+int main()
+{
+    // y = 1 + 2 P1(z0) + 0.5 P1(z0) P2(z1) - 0.25 P3(z1), x0 in [0, 2], x1 in [-3, 1]
+    ChaosMetamodel chaos( { legendre( 0, 2, 3 ), legendre( -3, 1, 3 ) },
+                          { {0, 0}, {1, 0}, {1, 2}, {0, 3} },
+                          { 1., 2., 0.5, -0.25 } );
+    auto reference = []( double const* x ) {
+        double z0 = x[0] - 1, z1 = ( x[1] + 1 ) / 2;
+        double p1 = std::sqrt(3.) * z0;
+        double q2 = std::sqrt(5.) * ( 3*z1*z1 - 1 ) / 2;
+        double q3 = std::sqrt(7.) * ( 5*z1*z1*z1 - 3*z1 ) / 2;
+        return 1 + 2*p1 + 0.5*p1*q2 - 0.25*q3;
+    };
+
+    std::string path = "test_metamodel.chaos";
+    chaos.save( path );
+    ChaosMetamodel loaded = ChaosMetamodel::load( path );
+    std::remove( path.c_str() );
+
+    std::mt19937 rng( 0 );
+    std::uniform_real_distribution<double> u0( 0, 2 ), u1( -3, 1 );
+    size_t n = 1001;
+    std::vector<double> X( 2*n ), Y( n );
+    for (size_t i = 0; i < n; ++i)
+    {
+        X[2*i] = u0( rng );
+        X[2*i + 1] = u1( rng );
+    }
+    loaded.evaluate( X.data(), n, Y.data() );
+
+    double error = 0;
+    for (size_t i = 0; i < n; ++i)
+        error = std::max( { error, std::abs( Y[i] - reference( &X[2*i] ) ), std::abs( chaos.evaluate( &X[2*i] ) - Y[i] ) } );
+    std::cout << "maximal error of the metamodel: " << error << std::endl;
+
+    // batch kernel, in row-major and structure-of-arrays layouts
+    ChaosBatchKernel kernel( loaded );
+    std::vector<double> Xsoa( 2*n ), Yrows( n ), Ysoa( n );
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < 2; ++j)
+            Xsoa[j*n + i] = X[2*i + j];
+    kernel.evaluateRows( X.data(), n, Yrows.data() );
+    kernel.evaluate( Xsoa.data(), n, n, Ysoa.data() );
+    double kernel_error = 0;
+    for (size_t i = 0; i < n; ++i)
+        kernel_error = std::max( { kernel_error, std::abs( Yrows[i] - Y[i] ), std::abs( Ysoa[i] - Y[i] ) } );
+    std::cout << "maximal error of the " << kernel.instructionSet() << " kernel: " << kernel_error << std::endl;
+
+    // every instruction set of the processor against the scalar loop
+    ChaosBatchKernel scalar( loaded, "scalar" );
+    std::vector<double> Yscalar( n ), Yset( n );
+    scalar.evaluate( Xsoa.data(), n, n, Yscalar.data() );
+    double set_error = 0;
+    for ( std::string const& set : ChaosBatchKernel::availableInstructionSets() )
+    {
+        ChaosBatchKernel vectorized( loaded, set );
+        vectorized.evaluate( Xsoa.data(), n, n, Yset.data() );
+        double e = 0;
+        for (size_t i = 0; i < n; ++i)
+            e = std::max( e, std::abs( Yset[i] - Yscalar[i] ) );
+        std::cout << "maximal difference of the " << set << " kernel to the scalar one: " << e << std::endl;
+        set_error = std::max( set_error, e );
+    }
+
+    // generated code, compiled and evaluated on the first points
+    std::string code = loaded.generateCode( "chaos_metamodel" );
+    std::cout << code;
+    size_t m = 16;
+    std::vector<double> Ycode = generatedValues( code, X.data(), m, 2 );
+    bool generated = Ycode.size() == m;
+    double code_error = 0;
+    for (size_t i = 0; generated && i < m; ++i)
+        code_error = std::max( code_error, std::abs( Ycode[i] - Y[i] ) );
+    if ( generated )
+        std::cout << "maximal error of the generated code: " << code_error << std::endl;
+    else
+        std::cout << "the generated code does not compile" << std::endl;
+
+    return ( error < 1e-12 && kernel_error < 1e-12 && set_error < 1e-12 && generated && code_error < 1e-12 ) ? 0 : 1;
+}
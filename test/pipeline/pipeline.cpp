@@ -0,0 +1,99 @@
+//! -*- mode: c++; coding: utf-8; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4; show-trailing-whitespace: t  -*- vim:fenc=utf-8:ft=cpp:et:sw=4:ts=4:sts=4
+//!
+//! This file is part of the Feel++ library
+//!
+//! This library is free software; you can redistribute it and/or
+//! modify it under the terms of the GNU Lesser General Public
+//! License as published by the Free Software Foundation; either
+//! version 2.1 of the License, or (at your option) any later version.
+//!
+//! This library is distributed in the hope that it will be useful,
+//! but WITHOUT ANY WARRANTY; without even the implied warranty of
+//! MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//! Lesser General Public License for more details.
+//!
+//! You should have received a copy of the GNU Lesser General Public
+//! License along with this library; if not, write to the Free Software
+//! Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+//!
+//! @file
+//! @author Thomas Saigre <saigre@math.unistra.fr>
+//! @date 18 Oct 2026
+//! @copyright 2026 Feel++ Consortium
+//! @brief Check the order, the back-pressure and the errors of the generate -> evaluate -> analyse pipeline
+//!
+//! Usage: feelpp_mor_test_pipeline
+//!
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../../src/common/BoundedQueue.hpp"
+
+
+struct Block
+{
+    size_t index = 0;
+    std::vector<double> values;
+};
+
+int main()
+{
+    bool ok = true;
+    size_t nblocks = 200, capacity = 4;
+
+    // the blocks are analysed in order, the generation never running more than the queues ahead of the analysis
+    std::atomic<size_t> generated{0}, analysed{0};
+    size_t ahead = 0, next = 0;
+    double sum = 0;
+    runPipeline<Block>( capacity,
+        [&]( Block& block ) {
+            if ( generated == nblocks )
+                return false;
+            ahead = std::max( ahead, generated - analysed );
+            block.index = generated++;
+            block.values.assign( 16, double( block.index ) );
+            return true;
+        },
+        []( Block& block ) {
+            for ( double& v : block.values )
+                v = 2 * v;
+        },
+        [&]( Block& block ) {
+            std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+            ok = ok && block.index == next++;
+            for ( double v : block.values )
+                sum += v;
+            ++analysed;
+        } );
+    double expected = 16. * nblocks * ( nblocks - 1 );
+    std::cout << "analysed " << analysed << " blocks, sum " << sum << " (expected " << expected << "), at most "
+              << ahead << " blocks ahead of the analysis" << std::endl;
+    ok = ok && analysed == nblocks && sum == expected && ahead <= 2 * capacity + 3;
+
+    // an error in the analysis stops the other stages and is rethrown
+    generated = 0;
+    bool thrown = false;
+    try
+    {
+        runPipeline<Block>( capacity,
+            [&]( Block& block ) { block.index = generated++; return true; },
+            []( Block& ) {},
+            []( Block& block ) {
+                if ( block.index == 10 )
+                    throw std::runtime_error( "analysis failed" );
+            } );
+    }
+    catch ( std::runtime_error const& e )
+    {
+        thrown = true;
+        std::cout << "error rethrown: " << e.what() << " after " << generated << " generated blocks" << std::endl;
+    }
+    ok = ok && thrown && generated <= 10 + 2 * capacity + 3;
+
+    return ok ? 0 : 1;
+}
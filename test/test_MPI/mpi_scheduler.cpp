@@ -0,0 +1,60 @@
+#include <iostream>
+#include <mpi.h>
+#include <cmath>
+#include <openturns/OT.hxx>
+#include "../../src/SA/MPIScheduler.hpp"
+
+/**
+ * @brief Evaluate a cheap function with the master/worker scheduler, and compare with a serial evaluation
+ *
+ * @param sample_size size of the sample to evaluate
+ * @param dim dimension of the input
+ * @return int 0 if the outputs match
+ */
+int schedule(size_t sample_size, size_t dim)
+{
+    MPI_Init(nullptr, nullptr);
+    // the level sent with the chunks is added to the output
+    auto f = [dim](double const* X, size_t n, double* Y, std::int64_t level) {
+        for (size_t i = 0; i < n; ++i)
+        {
+            Y[i] = level;
+            for (size_t j = 0; j < dim; ++j)
+                Y[i] += (j + 1) * X[i*dim + j];
+        }
+    };
+
+    int err = 0;
+    MPIScheduler scheduler(MPI_COMM_WORLD, 3);
+    if (scheduler.isMaster())
+    {
+        // two successive evaluations, to check that idle workers are reused
+        for (int run = 0; run < 2; ++run)
+        {
+            OT::Sample input = OT::Normal(dim).getSample(sample_size * (run + 1));
+            OT::Sample output = scheduler.evaluate(input, run);
+            std::vector<double> Y(input.getSize());
+            f(input.data(), input.getSize(), Y.data(), run);
+            for (size_t i = 0; i < input.getSize(); ++i)
+                if (std::abs(output(i, 0) - Y[i]) > 1e-12)
+                    err = 1;
+            std::cout << "run " << run << ": " << input.getSize() << " samples on " << scheduler.nWorkers() << " workers, "
+                << (err ? "error" : "ok") << std::endl;
+        }
+        scheduler.stop();
+    }
+    else
+        scheduler.serve(dim, f);
+
+    MPI_Bcast(&err, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return err;
+}
+
+
+int main(int argc, char *argv[])
+{
+    size_t sample_size = (argc > 1) ? atoi(argv[1]) : 1000;
+    size_t dim = (argc > 2) ? atoi(argv[2]) : 3;
+    return schedule(sample_size, dim);
+}